@@ -0,0 +1,223 @@
+#ifndef _ACTIONS_HPP_
+#define _ACTIONS_HPP_
+
+#include "sensors.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*=============
+** AUTONOMOUS ACTIONS
+=============*/
+/*Every autonomous step is an Action: started once, stepped once per control tick until it reports that it's
+	finished, then stopped. Because actions are resumable objects instead of blocking functions, they can be
+	combined and all driven from one task:
+
+		run(all(DriveMotion(...), ScoreAction(2)));    //finishes when both are done
+		run(race(DriveMotion(...), waitFor(1500)));    //finishes when the first one is done, the rest are cancelled
+		run(all(DriveMotion(...), sequence(waitFor(300), call(turnOnIntake))));    //one after another, alongside the drive
+
+	Combinators hold their children by value, so a whole tree lives on the stack of the task that runs it
+	(no heap, no extra tasks). Children are stepped in the order they were given.*/
+
+class Action{
+public:
+	virtual ~Action() {}
+
+	virtual void start(const SensorSnapshot& sensors) {}
+	//Returns true once the action is finished
+	virtual bool step(const SensorSnapshot& sensors) = 0;
+	//Called exactly once, when the action finishes or gets cancelled
+	virtual void stop() {}
+};
+
+//Finishes after a fixed time
+class WaitAction : public Action{
+public:
+	explicit WaitAction(std::uint32_t milliseconds) : milliseconds_(milliseconds) {}
+
+	void start(const SensorSnapshot& sensors) override{
+		begin_time_ = sensors.time;
+	}
+
+	bool step(const SensorSnapshot& sensors) override{
+		return sensors.time - begin_time_ >= milliseconds_;
+	}
+
+private:
+	std::uint32_t milliseconds_;
+	std::uint32_t begin_time_ = 0;
+};
+
+//Calls a function once and finishes straight away (turnOnIntake, stopHold, ...)
+class CallAction : public Action{
+public:
+	explicit CallAction(void (*function)()) : function_(function) {}
+
+	bool step(const SensorSnapshot& sensors) override{
+		function_();
+		return true;
+	}
+
+private:
+	void (*function_)();
+};
+
+/*=============
+** COMBINATORS
+=============*/
+template <typename... Actions>
+class AllAction : public Action{
+public:
+	explicit AllAction(Actions... actions) : actions_(std::move(actions)...) {}
+
+	void start(const SensorSnapshot& sensors) override{
+		startEach(sensors, std::index_sequence_for<Actions...>{});
+	}
+
+	bool step(const SensorSnapshot& sensors) override{
+		return stepEach(sensors, std::index_sequence_for<Actions...>{});
+	}
+
+	void stop() override{
+		stopEach(std::index_sequence_for<Actions...>{});
+	}
+
+private:
+	template <std::size_t... I>
+	void startEach(const SensorSnapshot& sensors, std::index_sequence<I...>){
+		(std::get<I>(actions_).start(sensors), ...);
+	}
+
+	//A child that finishes is stopped right away, the rest keep going
+	template <std::size_t... I>
+	bool stepEach(const SensorSnapshot& sensors, std::index_sequence<I...>){
+		bool all_done = true;
+		((done_[I] = done_[I] || finish(std::get<I>(actions_), sensors), all_done = all_done && done_[I]), ...);
+		return all_done;
+	}
+
+	template <std::size_t... I>
+	void stopEach(std::index_sequence<I...>){
+		((done_[I] ? void() : std::get<I>(actions_).stop()), ...);
+	}
+
+	template <typename A>
+	static bool finish(A& action, const SensorSnapshot& sensors){
+		if(action.step(sensors) == false) return false;
+		action.stop();
+		return true;
+	}
+
+	std::tuple<Actions...> actions_;
+	bool done_[sizeof...(Actions)] = {};
+};
+
+template <typename... Actions>
+class RaceAction : public Action{
+public:
+	explicit RaceAction(Actions... actions) : actions_(std::move(actions)...) {}
+
+	void start(const SensorSnapshot& sensors) override{
+		startEach(sensors, std::index_sequence_for<Actions...>{});
+	}
+
+	bool step(const SensorSnapshot& sensors) override{
+		return stepEach(sensors, std::index_sequence_for<Actions...>{});
+	}
+
+	//Stops the winner and cancels everyone else
+	void stop() override{
+		stopEach(std::index_sequence_for<Actions...>{});
+	}
+
+private:
+	template <std::size_t... I>
+	void startEach(const SensorSnapshot& sensors, std::index_sequence<I...>){
+		(std::get<I>(actions_).start(sensors), ...);
+	}
+
+	//Children after the winner aren't stepped on the tick it finishes
+	template <std::size_t... I>
+	bool stepEach(const SensorSnapshot& sensors, std::index_sequence<I...>){
+		bool finished = false;
+		((finished = finished || std::get<I>(actions_).step(sensors)), ...);
+		return finished;
+	}
+
+	template <std::size_t... I>
+	void stopEach(std::index_sequence<I...>){
+		(std::get<I>(actions_).stop(), ...);
+	}
+
+	std::tuple<Actions...> actions_;
+};
+
+//Runs its children one after another, each started on the tick the one before it finishes
+template <typename... Actions>
+class SequenceAction : public Action{
+public:
+	explicit SequenceAction(Actions... actions) : actions_(std::move(actions)...) {}
+
+	void start(const SensorSnapshot& sensors) override{
+		current_ = 0;
+		std::get<0>(actions_).start(sensors);
+	}
+
+	bool step(const SensorSnapshot& sensors) override{
+		return stepCurrent(sensors, std::index_sequence_for<Actions...>{});
+	}
+
+	//Only the child that's running needs cancelling, the earlier ones were stopped as they finished
+	void stop() override{
+		stopCurrent(std::index_sequence_for<Actions...>{});
+	}
+
+private:
+	template <std::size_t... I>
+	bool stepCurrent(const SensorSnapshot& sensors, std::index_sequence<I...>){
+		bool finished = false;
+		((I == current_ ? void(finished = std::get<I>(actions_).step(sensors)) : void()), ...);
+		if(finished == false) return false;
+
+		stopCurrent(std::index_sequence_for<Actions...>{});
+		current_ += 1;
+		((I == current_ ? std::get<I>(actions_).start(sensors) : void()), ...);
+		return current_ == sizeof...(Actions);
+	}
+
+	template <std::size_t... I>
+	void stopCurrent(std::index_sequence<I...>){
+		((I == current_ ? std::get<I>(actions_).stop() : void()), ...);
+	}
+
+	std::tuple<Actions...> actions_;
+	std::size_t current_ = 0;
+};
+
+template <typename... Actions>
+AllAction<std::decay_t<Actions>...> all(Actions&&... actions){
+	return AllAction<std::decay_t<Actions>...>(std::forward<Actions>(actions)...);
+}
+
+template <typename... Actions>
+RaceAction<std::decay_t<Actions>...> race(Actions&&... actions){
+	return RaceAction<std::decay_t<Actions>...>(std::forward<Actions>(actions)...);
+}
+
+template <typename... Actions>
+SequenceAction<std::decay_t<Actions>...> sequence(Actions&&... actions){
+	return SequenceAction<std::decay_t<Actions>...>(std::forward<Actions>(actions)...);
+}
+
+inline WaitAction waitFor(std::uint32_t milliseconds){
+	return WaitAction(milliseconds);
+}
+
+inline CallAction call(void (*function)()){
+	return CallAction(function);
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef _BALL_SORT_HPP_
+#define _BALL_SORT_HPP_
+
+#include "pros/vision.h"
+
+/*=============
+** VISION BALL SORTING
+=============*/
+/*Tracks the balls the vision sensor sees in front of the intake and decides, per ball, whether it gets
+	stored or ejected. Decisions are queued in the order balls enter the intake so the indexer can take them
+	one by one. Only plain vision objects go in, so recorded frames can be fed to it off the robot.*/
+
+//Vision sensor frame period (the sensor updates at 50 Hz)
+#define VISION_FRAME_MS 20
+
+//Objects read per signature per frame
+#define VISION_MAX_OBJECTS 4
+
+//Blobs smaller than this (px^2) are ignored
+#define BALL_MIN_AREA 300
+//Max distance (px) a ball may move between two frames and still be the same ball
+#define BALL_TRACK_GATE 45
+//Frames a track may go unseen before it's dropped
+#define BALL_TRACK_MAX_MISSES 3
+//Frames a track must be seen before it counts as a real ball
+#define BALL_TRACK_MIN_HITS 2
+//A ball whose bottom edge passes this line (px from the top of the frame) is being taken in
+#define BALL_INTAKE_LINE 170
+
+#define BALL_MAX_TRACKS 6
+#define BALL_MAX_DECISIONS 8
+
+enum BallDecision{
+	BALL_NONE,
+	BALL_STORE,
+	BALL_EJECT
+};
+
+struct BallTrack{
+	bool active;
+	int x;
+	int y;
+	int bottom;
+	int hits;
+	int misses;
+	int our_votes;
+	int their_votes;
+	bool decided;
+};
+
+class BallSorter{
+public:
+	BallSorter();
+
+	//Feeds one vision frame (objects of our color and objects of the opponent's color)
+	void update(const pros::vision_object_s_t* ours, int our_count, const pros::vision_object_s_t* theirs, int their_count);
+
+	//Decision for the next ball in the conveyer (BALL_NONE if nothing is queued)
+	BallDecision front() const;
+	BallDecision pop();
+	int pending() const;
+	void clear();
+
+	//Stats since the last clear
+	int storedCount() const;
+	int ejectedCount() const;
+
+private:
+	void match(const pros::vision_object_s_t& object, bool ours, bool* matched);
+	void push(BallDecision decision);
+
+	BallTrack tracks_[BALL_MAX_TRACKS];
+
+	BallDecision decisions_[BALL_MAX_DECISIONS];
+	int head_ = 0;
+	int size_ = 0;
+
+	int stored_ = 0;
+	int ejected_ = 0;
+};
+
+#endif
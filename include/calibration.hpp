@@ -0,0 +1,74 @@
+#ifndef _CALIBRATION_HPP_
+#define _CALIBRATION_HPP_
+
+#include "sd_card.hpp"
+#include "sensors.hpp"
+#include <cstdint>
+
+/*=============
+** CALIBRATION STORE
+=============*/
+/*What the robot has learned about its own sensors, kept on the SD card so a boot starts from the last
+	measurement instead of from nothing: the inertial sensor's gyro bias and heading drift when still, and the
+	tracking wheel scale factors. sensorUpdate() in main.cpp applies all of them: the bias comes off the gyro
+	rate the driver heading hold damps with, the drift off the heading, the scales onto the wheel ticks. The file is the raw struct behind a magic number, version and size and followed by a CRC-32, so
+	a file from another layout or a torn write is ignored rather than trusted.
+
+	While the robot sits disabled a CalibrationRefresh measures the sensors again and the new values are
+	saved. The scale factors can't be measured standing still; tools/calibration_edit.cpp sets them from a
+	push test (roll the robot a known distance and divide).
+
+	The line sensors aren't stored: the conveyer and goal checks compare raw readings against thresholds tuned
+	on the robot, and a reading taken while disabled can't anchor them because the preload sits in front of
+	the top sensor.*/
+
+#define CALIBRATION_FILE SD_DIR "calibration.bin"
+
+#define CALIBRATION_MAGIC 0x4C414335   //"5CAL"
+//Bump whenever CalibrationData changes, older files are then ignored
+#define CALIBRATION_VERSION 2
+
+struct CalibrationData{
+	//Inertial sensor while still: raw gyro z reading (degrees/s, taken off every reading before GYRO_RATE_SIGN)
+	//and how fast the heading creeps (degrees/s)
+	float gyro_bias = 0;
+	float heading_drift = 0;
+
+	//Tracking wheel ticks are multiplied by these
+	float left_scale = 1;
+	float right_scale = 1;
+	float center_scale = 1;
+
+	//Measurements saved so far, 0 if these are the defaults
+	std::uint32_t refreshes = 0;
+};
+
+//False (leaving data alone) if the file is missing, from another version or fails its checksum
+bool loadCalibration(const char* path, CalibrationData& data);
+bool saveCalibration(const char* path, const CalibrationData& data);
+
+//How long the robot has to stay still for one measurement, and how often it's sampled
+#define CALIBRATION_STILL_MS 10000
+#define CALIBRATION_SAMPLE_MS 20
+//Tracking wheel ticks between samples that still count as standing still
+#define CALIBRATION_STILL_TICKS 1
+
+//Averages the sensors over a window in which the robot doesn't move, starting over whenever it does
+class CalibrationRefresh{
+public:
+	void reset();
+
+	//Feeds one snapshot (heading already drift corrected) and the raw gyro z rate, bias not taken out. Returns
+	//true once a whole still window has been measured, with data updated from it
+	bool sample(const SensorSnapshot& sensors, double gyro_rate, CalibrationData& data);
+
+private:
+	bool started_ = false;
+	SensorSnapshot first_;
+	SensorSnapshot previous_;
+	double heading_change_ = 0;
+	double gyro_total_ = 0;
+	int samples_ = 0;
+};
+
+#endif
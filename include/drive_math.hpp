@@ -0,0 +1,110 @@
+#ifndef _DRIVE_MATH_HPP_
+#define _DRIVE_MATH_HPP_
+
+#include <algorithm>
+#include <cstdint>
+
+/*=============
+** DRIVE MATH
+=============*/
+/*The math the control loops run every tick: odometry, the angles drive() steers by and the field-centric
+	driver control transform. No devices or globals in here, so the host benchmarks (make bench) time exactly
+	the code the robot runs.*/
+
+#define PI 3.1415926
+
+//Pose from the tracking wheels, in encoder ticks and degrees
+struct Odometry{
+	float pos_x = 0;
+	float pos_y = 0;
+	float angle = 0;
+
+	//Encoder readings at the last update
+	float prev_fwd_rev = 0;
+	float prev_left_right = 0;
+};
+
+//Moves the pose by how far the tracking wheels turned since the last update, heading from the inertial sensor
+void odometryUpdate(Odometry& odometry, std::int32_t left_encoder, std::int32_t right_encoder, std::int32_t center_encoder, float heading);
+
+//Field bearing from the robot to the goal (whole degrees, clockwise from +y)
+int referenceAngle(float goal_x, float goal_y, float pos_x, float pos_y);
+//Direction to drive in relative to the robot's heading, for the bearing above
+float driveDirection(float heading, int reference_angle);
+//How far the heading is from the goal heading (unsigned degrees)
+float turnDifference(float heading, float goal_heading);
+
+struct WheelCommands{
+	int left_front;
+	int left_back;
+	int right_front;
+	int right_back;
+};
+
+//Largest value a controller stick reports
+#define STICK_MAX 127
+
+//Deadband and input shaping for every value a stick can report, worked out once so the driver loop only looks
+//them up. Readings within deadband of center count as 0 and the rest is stretched back over the full range,
+//then blended from linear (expo 0) to cubic (expo 1). StickCurve() (0, 0) passes the stick through unchanged.
+class StickCurve{
+public:
+	StickCurve(int deadband = 0, float expo = 0);
+
+	float operator()(std::int32_t value) const{
+		return shaped_[std::min(std::max(value, (std::int32_t)-STICK_MAX), (std::int32_t)STICK_MAX) + STICK_MAX];
+	}
+
+private:
+	float shaped_[2 * STICK_MAX + 1];
+};
+
+//The driver's sticks: readings this close to center count as 0 (controllers rest a few counts off), and how far
+//the response bends from linear towards cubic for finer control at low speed
+#define DRIVER_DEADBAND 5
+#define DRIVER_EXPO 0
+
+//Field-centric driver control: the left stick drives relative to the field, turn (from HeadingHold) spins the
+//robot. Works on the stick as a vector rotated into the robot's frame by the heading's sine and cosine, no
+//angles. A heading of PROS_ERR_F (failed inertial sensor) stops the wheels.
+WheelCommands fieldCentricDrive(const StickCurve& curve, std::int32_t up_down, std::int32_t left_right, float turn, float heading);
+
+/*=============
+** HEADING HOLD
+=============*/
+/*The right stick points the robot at a field heading and HeadingHold turns it there: a PD loop on the heading
+	error whose damping term is the inertial sensor's gyro rate, so it settles without hunting, and keeps the
+	last heading the stick set when it's let go, turning back after a bump. Update it once per driver control
+	tick; the gyro term doesn't depend on the tick length.*/
+
+//Turn command per degree of heading error, and per degree/s of turn rate against it. Raise HEADING_KP for
+//snappier turns, HEADING_KD if it overshoots
+#define HEADING_KP 4.0
+#define HEADING_KD 0.25
+//Fastest turn the hold asks for (motor command)
+#define HEADING_MAX_TURN 127
+//How far the right stick has to be pushed before its direction becomes the target, so it springing back to
+//center doesn't drag the target along
+#define HEADING_SET_MAGNITUDE 64
+
+class HeadingHold{
+public:
+	HeadingHold(float kp = HEADING_KP, float kd = HEADING_KD, float max_turn = HEADING_MAX_TURN);
+
+	//Holds heading from now on, call when driver control starts
+	void reset(float heading);
+
+	//Turn command for this tick, from the raw right stick, the heading and the gyro z rate (degrees/s clockwise,
+	//the way heading grows). 0 while the heading is PROS_ERR_F
+	float update(std::int32_t turnX, std::int32_t turnY, float heading, float gyro_rate);
+
+	float target() const;
+
+private:
+	float kp_;
+	float kd_;
+	float max_turn_;
+	float target_ = 0;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef _DRIVE_TUNING_HPP_
+#define _DRIVE_TUNING_HPP_
+
+/*=============
+** DRIVE TUNING
+=============*/
+/*Gains and thresholds of drive(). tools/optimize.cpp (make optimize) writes a file like this one from
+	simulated runs of the autonomous routine; copy it over this one to use its values.*/
+
+//Share of move/turn speed left when the robot is right on its goal
+#define KPBASE 0.11
+#define KPBASETURN 0.1
+
+//Distance (ticks) and heading error (degrees) where drive() starts slowing down
+#define CLOSE_MOVE 400
+#define CLOSE_TURN 35
+
+#endif
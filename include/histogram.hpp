@@ -0,0 +1,43 @@
+#ifndef _HISTOGRAM_HPP_
+#define _HISTOGRAM_HPP_
+
+#include <cstdint>
+
+/*=============
+** RUN TIME HISTOGRAM
+=============*/
+/*Fixed size histogram of microsecond durations. The first buckets are 25 us wide (where almost every control
+	update lands), after 400 us each bucket doubles, and the last one catches everything above 200 ms.
+	Percentiles come back as the upper edge of the bucket they fall in.*/
+
+#define HISTOGRAM_LINEAR_BUCKETS 16
+#define HISTOGRAM_LINEAR_WIDTH_US 25
+#define HISTOGRAM_BUCKETS 26
+
+class RunHistogram{
+public:
+	void add(std::uint32_t us);
+	void reset();
+
+	std::uint32_t count() const;
+	std::uint32_t min() const;
+	std::uint32_t max() const;
+	std::uint32_t average() const;
+	std::uint64_t total() const;
+
+	//percent from 0 to 100
+	std::uint32_t percentile(float percent) const;
+
+	static std::uint32_t bucketUpperEdge(int bucket);
+
+private:
+	static int bucketFor(std::uint32_t us);
+
+	std::uint32_t buckets_[HISTOGRAM_BUCKETS] = {};
+	std::uint32_t count_ = 0;
+	std::uint32_t min_ = 0;
+	std::uint32_t max_ = 0;
+	std::uint64_t total_ = 0;
+};
+
+#endif
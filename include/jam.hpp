@@ -0,0 +1,110 @@
+#ifndef _JAM_HPP_
+#define _JAM_HPP_
+
+#include "motor_health.hpp"
+#include "pros/rtos.hpp"
+#include <atomic>
+
+/*=============
+** JAM DETECTION
+=============*/
+/*A motor counts as jammed when it's being pushed hard in one direction but isn't turning while drawing stall
+	current (or torque). Recovery pulses it backwards to free the ball and then hands control back to whatever
+	command the code last gave it.*/
+
+struct JamConfig{
+	int min_command;         //Commands (-127 to 127) weaker than this are never treated as a jam
+	double max_velocity;     //RPM below which the motor counts as stalled
+	int min_current;         //mA at or above which a stalled motor counts as jammed
+	double min_torque;       //Nm at or above which a stalled motor counts as jammed
+	long detect_ms;          //How long a stall has to last before recovery starts
+	int reverse_speed;       //Speed of the reverse pulse
+	long reverse_ms;         //Length of the reverse pulse
+	long resume_ms;          //Time after the pulse where the original command runs without jam checks
+	int max_retries;         //Pulses in a row before giving up on the jam
+};
+
+//reverse_ms + resume_ms keeps a single recovery well under 300 ms
+constexpr JamConfig FEEDER_JAM_CONFIG = {80, 8, 1800, 0.8, 60, 127, 120, 100, 3};
+constexpr JamConfig INTAKE_JAM_CONFIG = {80, 8, 2000, 0.9, 80, 100, 100, 100, 2};
+
+enum JamState{
+	JAM_CLEAR,
+	JAM_SUSPECT,
+	JAM_REVERSING,
+	JAM_RESUMING,
+	JAM_FAILED
+};
+
+struct JamReading{
+	int command;
+	double velocity;
+	int current;
+	double torque;
+	bool over_current;
+};
+
+struct JamStats{
+	int jams;
+	int recovered;
+	int failed;
+	long total_recovery_ms;
+	long max_recovery_ms;
+};
+
+//Returned by JamDetector::update when the motor should get its normal command
+#define JAM_NO_OVERRIDE -1000
+
+class JamDetector{
+public:
+	explicit JamDetector(const JamConfig& config);
+
+	//Returns the command the motor should get right now (JAM_NO_OVERRIDE outside of a reverse pulse)
+	int update(const JamReading& reading, long time);
+
+	JamState state() const;
+	const JamStats& stats() const;
+
+private:
+	const JamConfig& config_;
+	JamStats stats_ = {0, 0, 0, 0, 0};
+
+	JamState state_ = JAM_CLEAR;
+	long state_time_ = 0;
+	long jam_time_ = 0;
+	int direction_ = 0;
+	int retries_ = 0;
+};
+
+/*=============
+** JAM GUARDED MOTOR
+=============*/
+/*Drop-in pros::Motor that remembers the last command it was given and runs the jam recovery on top of it.
+	Commands given during a reverse pulse are stored and applied once the pulse ends. Everything it sends
+	(pulses included) still goes through the health monitor's derating.
+
+	Checking whether a pulse is running and sending to the motor happen under one mutex, so a command can't
+	land on top of a pulse that started after it looked.*/
+class JamGuardedMotor : public DeratedMotor{
+public:
+	JamGuardedMotor(const std::uint8_t port, const JamConfig& config, const char* name);
+
+	std::int32_t move(std::int32_t voltage) const override;
+	std::int32_t move_voltage(const std::int32_t voltage) const override;
+
+	//Samples the motor and runs the detector, call at the motor's update rate (10 ms)
+	void updateJam();
+
+	JamState jamState() const;
+	const JamStats& jamStats() const;
+
+private:
+	//Written by the control tasks through move() and by the jam task in updateJam()
+	mutable std::atomic<int> command_ {0};
+	//Only read or written with output_mutex_ held, along with the send that depends on it
+	mutable bool overridden_ = false;
+	mutable pros::Mutex output_mutex_;
+	JamDetector detector_;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef _MACRO_HPP_
+#define _MACRO_HPP_
+
+#include "sd_card.hpp"
+#include "sensors.hpp"
+#include <cstdint>
+
+/*=============
+** DRIVER MACRO
+=============*/
+/*Records a driver control run and plays it back through the same opcontrol() pipeline, for skills. Every
+	driver tick stores the controller's sticks and buttons with the odometry pose at that moment; playback hands
+	the recorded controller state back tick for tick, steering it with the pose so small differences don't add
+	up: the position error is added to the left stick (field-centric, so the stick is a field direction), and the
+	heading hold is pointed at the recorded heading every tick. Replaying the right stick alone isn't enough,
+	the hold only takes a target from it once it's pushed past HEADING_SET_MAGNITUDE, so a recording started
+	while the driver held a heading would otherwise hold whatever heading playback started at.
+
+	Samples are kept in memory and written in one go when recording stops, as a header and the raw samples
+	(12 bytes each, 2.4 KB/s at CONTROL_PERIOD_MS), so stop recording before pulling the card.*/
+
+#define MACRO_FILE SD_DIR "macro.bin"
+
+#define MACRO_MAGIC 0x434D4135   //"5AMC"
+//Bump whenever MacroSample changes, older files are then refused
+#define MACRO_VERSION 1
+
+//Long enough for a skills run (60 s) at CONTROL_PERIOD_MS with room to spare
+#define MACRO_MAX_SAMPLES 14000
+
+//Stick counts added per encoder tick of position error, and the most the correction adds
+#define MACRO_POSITION_KP 0.5
+#define MACRO_MAX_CORRECTION 60
+
+//Controller state for one driver tick
+struct ControllerState{
+	std::int32_t analog[4];     //pros::controller_analog_e_t order: left x, left y, right x, right y
+	std::uint16_t buttons;      //bit 0 = L1, pros::controller_digital_e_t order (L1 L2 R1 R2 UP DOWN LEFT RIGHT X B Y A)
+};
+
+//Bit for a pros::controller_digital_e_t in ControllerState::buttons
+#define CONTROLLER_BUTTON(button) (1 << ((button) - pros::E_CONTROLLER_DIGITAL_L1))
+
+struct MacroSample{
+	//Odometry pose, encoder ticks and hundredths of a degree
+	std::int16_t pos_x;
+	std::int16_t pos_y;
+	std::uint16_t heading;
+
+	std::uint16_t buttons;
+	std::int8_t analog[4];
+};
+
+class DriverMacro{
+public:
+	bool recording() const;
+	bool playing() const;
+
+	//Starts a new recording, dropping whatever was recorded or loaded before
+	void startRecording(std::uint32_t period_ms);
+	//Stores one tick, false once the recording is full
+	bool record(const ControllerState& input, const SensorSnapshot& sensors);
+	//Ends the recording and writes it to path (nullptr only ends it), false if it wasn't written
+	bool stopRecording(const char* path);
+
+	//Reads a recording, false (leaving nothing to play) if it's missing, from another version or cut short
+	bool load(const char* path);
+	//Plays what was loaded or last recorded from now on, false if there's nothing
+	bool startPlayback(std::uint32_t now);
+	//Replaces input with the recorded controller state for now, corrected towards the recorded pose, and sets
+	//heading to the recorded one for the heading hold (PROS_ERR_F if it wasn't known). Returns false (input
+	//centred) once the recording has run out
+	bool play(std::uint32_t now, const SensorSnapshot& sensors, ControllerState& input, float& heading);
+	void stopPlayback();
+
+	std::uint32_t count() const;
+	std::uint32_t periodMs() const;
+
+private:
+	enum State{
+		IDLE,
+		RECORDING,
+		PLAYING
+	};
+
+	State state_ = IDLE;
+	std::uint32_t period_ms_ = 0;
+	std::uint32_t count_ = 0;
+	std::uint32_t start_ms_ = 0;
+	MacroSample samples_[MACRO_MAX_SAMPLES];
+};
+
+#endif
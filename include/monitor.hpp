@@ -0,0 +1,40 @@
+#ifndef _MONITOR_HPP_
+#define _MONITOR_HPP_
+
+#include "scheduler.hpp"
+#include "screen.hpp"
+
+/*=============
+** RUNTIME MONITOR
+=============*/
+/*Turns the scheduler's per-loop run time histograms into a CPU budget: how long each subsystem update takes
+	(min/avg/max/p99) and what share of the brain's time it has used since the scheduler started.
+	Run times are measured with micros() from wake-up to the end of the update, so time spent preempted by
+	a higher priority task counts against the loop that was preempted.*/
+
+#define MONITOR_PERIOD_MS 1000
+
+//Brain screen lines used by the monitor
+#define MONITOR_LCD_TOTAL_LINE 4
+#define MONITOR_LCD_LOOP_LINE 7
+
+class RuntimeMonitor{
+public:
+	explicit RuntimeMonitor(const Scheduler& scheduler);
+
+	//Percent of time since the scheduler started spent in one loop, or in all of them
+	float cpuShare(int index) const;
+	float totalCpuShare() const;
+
+	//Prints every loop over serial
+	void printReport() const;
+
+	//Shows the total on one screen line and cycles through the loops on another
+	void updateScreen(Screen& screen);
+
+private:
+	const Scheduler& scheduler_;
+	int screen_cursor_ = 0;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef _MOTOR_HEALTH_HPP_
+#define _MOTOR_HEALTH_HPP_
+
+#include "pros/motors.hpp"
+#include <atomic>
+#include <cstdint>
+
+/*=============
+** MOTOR HEALTH
+=============*/
+/*V5 motors cut their own current limit as they heat up (to half at 55 C, then further every 5 C until they
+	stop at 70 C), so a motor that gets hot late in skills suddenly loses speed. The health monitor samples
+	every motor's temperature, current, faults and flags a few times a second and derates a whole group
+	(the drivetrain, the conveyer) smoothly before that happens.
+
+	Temperature only changes in 5 C steps, so the heating rate is taken from the time between steps and the
+	derating is based on where the temperature is heading HEALTH_LOOKAHEAD_S from now. A group is always
+	derated as one, since slowing a single X-drive wheel would bend the robot's path instead of slowing it.*/
+
+#define HEALTH_PERIOD_MS 250
+
+#define HEALTH_TEMP_STEP_C 5.0
+#define HEALTH_DERATE_START_C 45.0     //No derating below this
+#define HEALTH_LIMIT_C 55.0            //Where the motor's own limiting starts, derating is at its strongest here
+#define HEALTH_MIN_SCALE 0.6
+#define HEALTH_LOOKAHEAD_S 20.0
+#define HEALTH_MAX_PREDICTED_RISE_C 10.0
+
+//Largest change in a group's scale per sample, derating kicks in faster than it lets go
+#define HEALTH_SCALE_DOWN_STEP 0.04
+#define HEALTH_SCALE_UP_STEP 0.01
+
+#define HEALTH_MAX_MOTORS 8
+#define HEALTH_MAX_GROUPS 4
+#define HEALTH_MAX_EVENTS 32
+
+/*Drop-in pros::Motor whose commands are scaled by the health monitor's derating (1 when healthy).
+	Derating applies to move() and move_voltage(), holding with move(0) is unaffected.*/
+class DeratedMotor : public pros::Motor{
+public:
+	DeratedMotor(const std::uint8_t port, const char* name);
+
+	std::int32_t move(std::int32_t voltage) const override;
+	std::int32_t move_voltage(const std::int32_t voltage) const override;
+
+	void setScale(float scale);
+	float scale() const;
+	const char* name() const;
+
+private:
+	std::atomic<float> scale_ {1};
+	const char* name_;
+};
+
+enum HealthEventType{
+	HEALTH_WARM,           //Passed HEALTH_DERATE_START_C
+	HEALTH_OVER_TEMP,      //Motor reports over temperature
+	HEALTH_FAULT,          //New fault bits (value holds them)
+	HEALTH_UNREACHABLE,    //Motor stopped answering
+	HEALTH_DERATE          //Group scale crossed a 10% step (value in percent)
+};
+
+struct HealthEvent{
+	std::uint32_t time;
+	const char* name;      //Motor or group
+	HealthEventType type;
+	std::int32_t value;
+};
+
+struct MotorHealth{
+	DeratedMotor* motor;
+	double temperature;
+	double peak_temperature;
+	double heating_rate;           //C per second
+	std::int32_t current;          //mA
+	std::int32_t peak_current;
+	std::uint32_t faults;
+	std::uint32_t flags;
+	bool over_temp;
+
+	double last_step_temperature;
+	std::uint32_t last_step_time;
+};
+
+class MotorHealthMonitor{
+public:
+	//Motors in a group share one derating, false if the tables are full
+	bool addGroup(const char* name, DeratedMotor* const* motors, int count);
+
+	//Samples every motor and updates the derating, call every HEALTH_PERIOD_MS
+	void update();
+
+	float groupScale(int group) const;
+	//Hottest motor right now
+	double maxTemperature() const;
+
+	//Prints every motor and the logged events over serial
+	void report() const;
+
+private:
+	struct Group{
+		const char* name;
+		int first;
+		int count;
+		float scale;
+	};
+
+	void sample(MotorHealth& health, std::uint32_t now);
+	float targetScale(const MotorHealth& health) const;
+	void logEvent(std::uint32_t time, const char* name, HealthEventType type, std::int32_t value);
+
+	MotorHealth motors_[HEALTH_MAX_MOTORS];
+	int motor_count_ = 0;
+	Group groups_[HEALTH_MAX_GROUPS];
+	int group_count_ = 0;
+
+	HealthEvent events_[HEALTH_MAX_EVENTS];
+	int event_count_ = 0;
+	int events_lost_ = 0;
+};
+
+#endif
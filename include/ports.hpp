@@ -0,0 +1,34 @@
+#ifndef _PORTS_HPP_
+#define _PORTS_HPP_
+
+/*=============
+** PORT DECLARATIONS
+=============*/
+//Shared with the host simulator (sim/), which wires its simulated devices to the same ports
+#define LEFT_WHEEL_FRONT_PORT 13
+#define LEFT_WHEEL_BACK_PORT 17
+#define RIGHT_WHEEL_FRONT_PORT 8
+#define RIGHT_WHEEL_BACK_PORT 7
+
+#define FEEDER_MIDDLE_PORT 18
+#define FEEDER_TOP_PORT 6
+
+#define LEFT_INTAKE_PORT 16
+#define RIGHT_INTAKE_PORT 10
+
+#define IMU_PORT 19
+
+#define VISION_PORT 3
+
+#define LEFT_ENCODER_TOP 8
+#define LEFT_ENCODER_BOTTOM 7
+#define CENTER_ENCODER_TOP 6
+#define CENTER_ENCODER_BOTTOM 5
+#define RIGHT_ENCODER_TOP 4
+#define RIGHT_ENCODER_BOTTOM 3
+
+#define ANALOG_SENSOR_PORT1 1
+#define ANALOG_SENSOR_PORT2 2
+#define ANALOG_SENSOR_PORT3 9
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef _PROFILE_HPP_
+#define _PROFILE_HPP_
+
+/*=============
+** HOT PATH PROFILING
+=============*/
+/*Scoped timers for finding out where a control tick goes. Each site gets its own run time histogram:
+
+		PROFILE_SCOPE("lcd");                  //times the rest of the enclosing block
+		PROFILE_START(angle, "drive.angle");   //times until PROFILE_STOP(angle) or the end of the block
+		...
+		PROFILE_STOP(angle);
+
+	Sites register themselves the first time they run and profileReport() prints them all over serial.
+	A site's histogram isn't locked, so every site should only ever run in one task.
+
+	Profiling is off unless the build defines ENABLE_PROFILING (make PROFILE=1). When it's off every macro
+	expands to nothing, so release builds don't even read the clock.*/
+
+#ifdef ENABLE_PROFILING
+
+#include "histogram.hpp"
+#include "pros/rtos.hpp"
+#include <cstdint>
+
+#define PROFILE_MAX_SITES 24
+
+struct ProfileSite{
+	explicit ProfileSite(const char* name);
+
+	const char* name;
+	RunHistogram run_time;
+};
+
+class ProfileTimer{
+public:
+	explicit ProfileTimer(ProfileSite& site) : site_(&site), start_us_(pros::micros()) {}
+
+	~ProfileTimer(){
+		stop();
+	}
+
+	void stop(){
+		if(site_ == nullptr) return;
+		site_->run_time.add(pros::micros() - start_us_);
+		site_ = nullptr;
+	}
+
+private:
+	ProfileSite* site_;
+	std::uint64_t start_us_;
+};
+
+void profileReport();
+void profileReset();
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_START(id, name) \
+	static ProfileSite PROFILE_CONCAT(profile_site_, id) (name); \
+	ProfileTimer PROFILE_CONCAT(profile_timer_, id) (PROFILE_CONCAT(profile_site_, id))
+#define PROFILE_STOP(id) PROFILE_CONCAT(profile_timer_, id).stop()
+#define PROFILE_SCOPE(name) PROFILE_START(PROFILE_CONCAT(line_, __LINE__), name)
+
+#else
+
+#define PROFILE_START(id, name)
+#define PROFILE_STOP(id)
+#define PROFILE_SCOPE(name)
+
+inline void profileReport() {}
+inline void profileReset() {}
+
+#endif
+
+#endif
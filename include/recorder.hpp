@@ -0,0 +1,67 @@
+#ifndef _RECORDER_HPP_
+#define _RECORDER_HPP_
+
+#include "pros/rtos.hpp"
+#include "sd_card.hpp"
+#include "telemetry_codec.hpp"
+#include <atomic>
+#include <cstdio>
+
+/*=============
+** FLIGHT RECORDER
+=============*/
+/*Keeps every telemetry frame of a run on the SD card. Frames are encoded into one of two buffers. When a
+	buffer is full the two swap and a low priority writer task puts the full one on the card in a single
+	fwrite(), so the control side only ever copies bytes into memory.
+
+	The file is the same COBS packet stream the serial telemetry uses, so tools/telemetry_decode.cpp reads it
+	as a capture file. flush() hands over the half full buffer and closes the file; call it when autonomous()
+	returns and from disabled(), since the field kills the autonomous task when it disables the robot.*/
+
+//Runs go to SD_DIR flight_00.bin, flight_01.bin, ... (the first free name)
+#define FLIGHT_RECORDER_MAX_FILES 100
+
+//About 2 s of frames per buffer at 100 Hz, one card write every couple of seconds
+#define FLIGHT_BUFFER_SIZE 8192
+
+//Longest flush() waits for the writer to finish
+#define FLIGHT_FLUSH_TIMEOUT_MS 500
+
+class FlightRecorder{
+public:
+	//Picks a file name and starts the writer task, false if there's no SD card
+	bool start();
+
+	//Called from the sampling callback only, false if the frame was dropped (card too slow or not started)
+	bool record(const TelemetryFrame& frame);
+
+	//Writes out everything recorded so far and closes the file (the next frame reopens it)
+	void flush();
+
+	std::uint32_t dropped() const;
+
+private:
+	static void writerTask(void* recorder);
+
+	//Passes the filling buffer to the writer, needs mutex_
+	bool handOff();
+
+	std::uint8_t buffers_[2][FLIGHT_BUFFER_SIZE];
+	int fill_ = 0;
+	std::size_t used_ = 0;
+
+	//Buffer waiting for the writer (-1 for none) and how much of it is used
+	std::atomic<int> pending_ {-1};
+	std::size_t pending_size_ = 0;
+	std::atomic<bool> close_requested_ {false};
+
+	TelemetryEncoder encoder_;
+	pros::Mutex mutex_;
+	pros::task_t writer_ = nullptr;
+	std::atomic<std::uint32_t> dropped_ {0};
+
+	char path_[32] = {};
+	std::FILE* file_ = nullptr;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef _SCHEDULER_HPP_
+#define _SCHEDULER_HPP_
+
+#include "histogram.hpp"
+#include <cstdint>
+
+/*=============
+** CONTROL SCHEDULER
+=============*/
+/*Background subsystems (odometry, jam checks, vision, display) register an update callback with a period.
+	Callbacks that share a period run back to back in one task paced with Task::delay_until, so every period
+	costs a single task no matter how many subsystems use it.
+
+	Loops that have to stay in a competition task (drive(), scoreAndStore(), opcontrol()) pace themselves
+	with ControlRate instead, which records the same timing stats.*/
+
+#define SCHEDULER_MAX_CALLBACKS 12
+#define SCHEDULER_MAX_GROUPS 8
+#define SCHEDULER_MAX_LOOPS 6
+
+//Period of the drive/indexer loops (motors only take new commands every 5 ms)
+#define CONTROL_PERIOD_MS 5
+
+struct LoopStats{
+	const char* name;
+	std::uint32_t period_ms;
+	std::uint32_t runs;
+	std::uint32_t overruns;          //Runs that took longer than the period
+	std::uint32_t max_jitter_us;     //Worst difference between the actual and the ideal period
+	std::uint64_t total_jitter_us;
+	RunHistogram run_time;           //How long each run took
+	std::uint32_t last_run_us = 0;   //Newest run, for telemetry
+};
+
+typedef void (*UpdateCallback)();
+
+class Scheduler;
+
+//Paces a blocking loop at a fixed period, call wait() at the end of every iteration
+class ControlRate{
+public:
+	ControlRate(LoopStats* stats);
+
+	void wait();
+
+private:
+	LoopStats* stats_;
+	std::uint32_t wake_ms_;
+	std::uint64_t start_us_;
+};
+
+class Scheduler{
+public:
+	//Registers a subsystem update, must be called before start(). Returns its stats, nullptr if it didn't fit
+	const LoopStats* add(const char* name, UpdateCallback callback, std::uint32_t period_ms, std::uint32_t priority);
+
+	//Registers stats for a loop that paces itself with ControlRate
+	LoopStats* addLoop(const char* name, std::uint32_t period_ms);
+
+	//Creates one task per (period, priority) group
+	void start();
+
+	//micros() when start() was called
+	std::uint64_t startTime() const;
+
+	int count() const;
+	const LoopStats& stats(int index) const;
+
+	//Prints every callback's and loop's timing over serial
+	void report() const;
+
+private:
+	struct Group{
+		std::uint32_t period_ms;
+		std::uint32_t priority;
+		int callbacks[SCHEDULER_MAX_CALLBACKS];
+		int callback_count;
+		Scheduler* scheduler;
+	};
+
+	static void groupTask(void* group);
+
+	//Loops registered with addLoop() have no callback
+	struct Entry{
+		UpdateCallback callback;
+		LoopStats stats;
+	};
+
+	Entry entries_[SCHEDULER_MAX_CALLBACKS + SCHEDULER_MAX_LOOPS];
+	int count_ = 0;
+	int callback_count_ = 0;
+
+	Group groups_[SCHEDULER_MAX_GROUPS];
+	int group_count_ = 0;
+	bool started_ = false;
+	std::uint64_t start_us_ = 0;
+};
+
+//Adds one run to a loop's stats (actual_period_us is 0 on the first run)
+void recordRun(LoopStats& stats, std::uint64_t actual_period_us, std::uint64_t run_us);
+
+#endif
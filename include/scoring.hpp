@@ -0,0 +1,176 @@
+#ifndef _SCORING_HPP_
+#define _SCORING_HPP_
+
+/*=============
+** SCORING RECIPES
+=============*/
+/*Every goal type we score on is described by a recipe in SCORE_RECIPES below. A single interpreter
+	(ScoreInterpreter) runs any of them, so tuning a goal or adding a new one only means editing the table.
+	The interpreter never touches hardware itself: it takes sensor readings in and hands motor commands back,
+	which keeps it usable off the robot.*/
+
+//Used for any time field that should never fire
+#define SCORE_NEVER -1L
+//Used for any motor command that should leave the motor as it is
+#define SCORE_KEEP -1000
+
+/*Middle roller indexing (balls that get stored after scoring)
+	phase 1: a ball reaches the second ball sensor
+	phase 2: that ball leaves the second sensor again (only after phase2_after ms)
+	phase 3: the next ball reaches the first ball sensor*/
+struct ScoreIndex{
+	bool enabled;
+	int slow_speed;          //Middle roller speed once the slow trigger phase is reached
+	int slow_phase;          //Phase (2 or 3) that slows the middle roller down
+	long phase2_after;       //Earliest time phase 2 may start
+	long hold_after;         //Earliest time the middle roller may lock the stored ball
+	int hold_offset;         //Encoder ticks the middle roller backs off when it locks a ball
+	int hold_speed;          //Speed used to stay on the locked position
+};
+
+/*Ejecting the balls we don't want and counting what passes (used by goals that need both)
+	Starts once phase 2 has been reached*/
+struct ScoreEject{
+	long eject_after;        //Time after phase 2 when the conveyer switches to pooping
+	long count_after;        //Time after phase 2 when balls passing sensor 2 start being counted
+	int count_target;        //Number of counted balls that finishes the recipe (0 = never)
+	long count_settle;       //Extra time to keep running once the count is reached
+};
+
+/*Stopping the conveyer as soon as the second ball sensor sees a ball (goals with nothing to store)*/
+struct ScoreStop{
+	bool enabled;
+	long stop_after;         //Earliest time the stop may trigger
+	long top_delay;          //Time between stopping the middle roller and stopping the top roller
+};
+
+/*Intake timing, everything measured from the start of the recipe*/
+struct ScoreIntake{
+	bool off_at_start;
+	long on_from;            //Intake runs between on_from and on_until
+	long on_until;
+	long off_after;          //Intake turned off after this time (outside the on window)
+};
+
+struct ScoreRecipe{
+	int ball;
+
+	//Motor commands when the recipe starts (the chassis creeps into the goal while scoring, 0 = leave it alone)
+	int top_speed;
+	int middle_speed;
+	int creep_speed;
+
+	ScoreIntake intake;
+	ScoreIndex index;
+	ScoreEject eject;
+	ScoreStop stop;
+
+	long timeout;
+};
+
+//Sensor thresholds shared by every recipe
+#define SCORE_SENSOR2_ENTER 1800
+#define SCORE_SENSOR2_LEAVE 1650
+#define SCORE_SENSOR2_COUNT 1700
+#define SCORE_SENSOR1_ENTER 180
+
+constexpr ScoreIndex NO_INDEX = {false, 0, 0, 0, 0, 0, 0};
+constexpr ScoreEject NO_EJECT = {SCORE_NEVER, SCORE_NEVER, 0, 0};
+constexpr ScoreStop NO_STOP = {false, 0, 0};
+
+constexpr ScoreRecipe SCORE_RECIPES[] = {
+	//Corner goal, two stored balls
+	{1, -127, -127/10*8, 20,
+		{false, SCORE_NEVER, SCORE_NEVER, 600},
+		{true, int(-127/1.8), 2, 200, 150, 230, 127},
+		NO_EJECT, NO_STOP, 760},
+	//Side goal, intake pulses to pull the next ball in
+	{2, -127, -127/10*8, 30,
+		{true, 180, 340, 340},
+		{true, int(-127/1.5), 3, 200, 100, 270, 127},
+		NO_EJECT, NO_STOP, 800},
+	//Center goal, scores then poops two balls out
+	{3, -127, -127, 0,
+		{true, 50, 1000000L, SCORE_NEVER},
+		{true, int(-127/1.8), 2, 200, 300, 300, 127},
+		{500, 550, 2, 60}, NO_STOP, 2200},
+	//Corner goal, nothing to store
+	{4, -127, -127/10*8, 20,
+		{false, SCORE_NEVER, SCORE_NEVER, SCORE_NEVER},
+		NO_INDEX, NO_EJECT, {true, 150, 0}, 600},
+	//Side goal, middle roller stops first so the top roller finishes the ball
+	{5, -127, -127/2, 20,
+		{false, SCORE_NEVER, SCORE_NEVER, 400},
+		NO_INDEX, NO_EJECT, {true, 0, 250}, 450},
+};
+
+//Returns the recipe for a ball/goal number, or nullptr if there is none
+constexpr const ScoreRecipe* findScoreRecipe(int ball){
+	for(const ScoreRecipe& recipe : SCORE_RECIPES){
+		if(recipe.ball == ball) return &recipe;
+	}
+	return nullptr;
+}
+
+/*=============
+** SCORING INTERPRETER
+=============*/
+enum ScoreIntakeCommand{
+	SCORE_INTAKE_KEEP,
+	SCORE_INTAKE_ON,
+	SCORE_INTAKE_OFF
+};
+
+//Sensor readings for one tick
+struct ScoreInput{
+	long elapsed;            //Time since the recipe started
+	int ball_sensor;
+	int ball_sensor2;
+	double middle_position;
+};
+
+//Motor commands for one tick (SCORE_KEEP leaves the motor alone)
+struct ScoreOutput{
+	int top_speed = SCORE_KEEP;
+	int middle_speed = SCORE_KEEP;
+	int creep_speed = SCORE_KEEP;
+	bool hold_top = false;
+	bool hold_middle = false;
+	ScoreIntakeCommand intake = SCORE_INTAKE_KEEP;
+};
+
+class ScoreInterpreter{
+public:
+	explicit ScoreInterpreter(const ScoreRecipe& recipe);
+
+	//Commands to apply once before the first step
+	ScoreOutput start();
+	ScoreOutput step(const ScoreInput& input);
+
+	bool done() const;
+	//The eject has counted all its balls through (the settle time may still be running)
+	bool counted() const;
+
+private:
+	const ScoreRecipe& recipe_;
+
+	bool phase1_ = false;
+	bool phase2_ = false;
+	bool phase3_ = false;
+	long phase2_time_ = 0;
+
+	bool holding_ = false;
+	double hold_position_ = 0;
+
+	bool engaged_ = false;
+	int count_ = 0;
+	long counted_time_ = 0;
+
+	bool stopped_ = false;
+	bool top_stopped_ = false;
+	long stopped_time_ = 0;
+
+	bool done_ = false;
+};
+
+#endif
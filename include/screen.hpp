@@ -0,0 +1,60 @@
+#ifndef _SCREEN_HPP_
+#define _SCREEN_HPP_
+
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include <cstdint>
+
+/*=============
+** SCREEN OUTPUT
+=============*/
+/*All brain screen and controller screen output goes through here. Any task can set a line (printf style,
+	formatted into a fixed buffer, no heap); update() runs in the low priority display task and only sends the
+	lines that changed since they were last drawn.
+
+	The controller only takes a new message about every 50 ms and drops anything sent faster, so update()
+	sends at most one controller line or rumble per CONTROLLER_MESSAGE_MS, rumbles first.*/
+
+//Brain screen lines (0-7) and the longest text one of them shows
+#define SCREEN_LINES 8
+#define SCREEN_LINE_LENGTH 48
+
+//Controller screen is 3 lines of 15 characters
+#define CONTROLLER_LINES 3
+#define CONTROLLER_LINE_LENGTH 15
+#define CONTROLLER_MESSAGE_MS 50
+
+//Longest rumble pattern the controller plays ('.' short, '-' long, ' ' pause)
+#define CONTROLLER_RUMBLE_LENGTH 8
+
+class Screen{
+public:
+	explicit Screen(pros::Controller& controller);
+
+	void setLine(int line, const char* format, ...) __attribute__((format(printf, 3, 4)));
+	void setControllerLine(int line, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+	//Plays once, a newer pattern replaces one that hasn't been sent yet
+	void rumble(const char* pattern);
+
+	//Sends whatever changed, call from the display task only
+	void update();
+
+private:
+	bool updateController();
+
+	pros::Controller& controller_;
+	pros::Mutex mutex_;
+
+	char lines_[SCREEN_LINES][SCREEN_LINE_LENGTH] = {};
+	char drawn_lines_[SCREEN_LINES][SCREEN_LINE_LENGTH] = {};
+
+	char controller_lines_[CONTROLLER_LINES][CONTROLLER_LINE_LENGTH + 1] = {};
+	char drawn_controller_lines_[CONTROLLER_LINES][CONTROLLER_LINE_LENGTH + 1] = {};
+	int controller_cursor_ = 0;
+
+	char rumble_[CONTROLLER_RUMBLE_LENGTH + 1] = {};
+	std::uint32_t last_message_time_ = 0;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _SD_CARD_HPP_
+#define _SD_CARD_HPP_
+
+/*=============
+** SD CARD
+=============*/
+/*Every file the robot keeps (flight recordings, segments.csv, calibration.bin, macro.bin) lives in SD_DIR.
+	FatFs only commits a file to the card when it's closed, so each writer closes its file as soon as it's
+	done with it.
+
+	Host builds (HOST_BUILD) keep the files in the working directory instead of /usd/.*/
+
+#ifdef HOST_BUILD
+#define SD_DIR ""
+#else
+#define SD_DIR "/usd/"
+#endif
+
+#endif
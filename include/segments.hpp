@@ -0,0 +1,67 @@
+#ifndef _SEGMENTS_HPP_
+#define _SEGMENTS_HPP_
+
+#include <cstdint>
+#include <cstdio>
+
+/*=============
+** AUTONOMOUS SEGMENTS
+=============*/
+/*Every drive() and scoreAndStore() of a run is logged as a segment: when it started and ended (relative to
+	the start of the run), why it ended and how far the robot was from the goal pose at that point.
+
+	The log comes out as CSV, over serial with a "[seg] " prefix in front of every line and on the SD card.
+	tools/segment_diff.cpp reads either and shows which segments got slower between two runs.*/
+
+//The route has around 70 segments, leaves room to add more
+#define SEGMENT_MAX 128
+
+enum SegmentExit{
+	SEGMENT_REACHED,       //Drive got within tolerance of the goal pose
+	SEGMENT_GOAL_SENSOR,   //Drive ended early on the goal sensor
+	SEGMENT_DONE,          //Scoring recipe finished
+	SEGMENT_CANCELLED,     //Stopped by a race() before finishing
+	SEGMENT_SKIPPED        //Nothing to do (no recipe for that many balls)
+};
+
+struct Segment{
+	const char* kind;
+	std::uint32_t start_ms;
+	std::uint32_t end_ms;
+	SegmentExit exit;
+	float goal_x;
+	float goal_y;
+	float goal_heading;
+	float position_error;      //Encoder ticks, like the odometry pose
+	float heading_error;       //degrees, always positive
+};
+
+class SegmentLog{
+public:
+	//Clears the log, times are relative to now
+	void reset(std::uint32_t now);
+
+	//Returns the segment's index for end(), -1 if the log is full
+	int begin(const char* kind, std::uint32_t now, float goal_x, float goal_y, float goal_heading);
+	void end(int index, std::uint32_t now, SegmentExit exit, float pos_x, float pos_y, float heading);
+
+	int count() const;
+	const Segment& segment(int index) const;
+
+	//prefix goes in front of every line ("[seg] " for serial, "" for a file)
+	void writeCsv(std::FILE* file, const char* prefix) const;
+	bool saveCsv(const char* path) const;
+
+private:
+	Segment segments_[SEGMENT_MAX];
+	int count_ = 0;
+	std::uint32_t start_ms_ = 0;
+	bool overflowed_ = false;
+};
+
+//Column names shared by the robot and tools/segment_diff.cpp
+#define SEGMENT_CSV_HEADER "index,kind,start_ms,end_ms,duration_ms,exit,goal_x,goal_y,goal_heading,position_error,heading_error"
+
+extern const char* const SEGMENT_EXIT_NAMES[];
+
+#endif
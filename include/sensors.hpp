@@ -0,0 +1,39 @@
+#ifndef _SENSORS_HPP_
+#define _SENSORS_HPP_
+
+#include <cstdint>
+
+/*=============
+** SENSOR SNAPSHOT
+=============*/
+/*Every control tick works off one snapshot: each device is read exactly once per odometry period, the pose is
+	updated from those same readings, and the whole thing is published together. Loops copy the latest snapshot
+	at the start of a tick so everything they decide on comes from the same instant.*/
+
+struct SensorSnapshot{
+	std::uint32_t time;
+
+	//Pose computed from the readings below
+	float pos_x;
+	float pos_y;
+	float heading;
+
+	//Inertial sensor z rate, degrees/s clockwise (GYRO_RATE_SIGN in main.cpp) with the calibrated bias taken out
+	float gyro_rate;
+
+	//Tracking wheels
+	std::int32_t left_encoder;
+	std::int32_t right_encoder;
+	std::int32_t center_encoder;
+
+	//Conveyer motor encoders
+	float top_position;
+	float middle_position;
+
+	//Line sensors (12 bit)
+	std::int16_t ball_sensor;
+	std::int16_t ball_sensor2;
+	std::int16_t goal_sensor;
+};
+
+#endif
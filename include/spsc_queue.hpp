@@ -0,0 +1,99 @@
+#ifndef _SPSC_QUEUE_HPP_
+#define _SPSC_QUEUE_HPP_
+
+#include "pros/rtos.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*=============
+** SPSC QUEUE
+=============*/
+/*Fixed capacity lock-free ring buffer for passing commands from exactly one producer task to exactly one
+	consumer task. push() and pop() never block and never allocate. A consumer that would rather sleep
+	registers itself with setConsumer() and uses popWait(), which sleeps on a task notification that push()
+	sends.
+
+	head_ is only written by the consumer and tail_ only by the producer, so each side owns one index and
+	the acquire/release pairs below are all the synchronisation needed.*/
+
+template <typename T, std::size_t Capacity>
+class SpscQueue{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+	//Producer side, false if the queue is full
+	bool push(const T& item){
+		std::size_t tail = tail_.load(std::memory_order_relaxed);
+		if(tail - head_.load(std::memory_order_acquire) == Capacity){
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		items_[tail & (Capacity - 1)] = item;
+		tail_.store(tail + 1, std::memory_order_release);
+
+		pros::task_t consumer = consumer_.load(std::memory_order_acquire);
+		if(consumer != nullptr) pros::c::task_notify(consumer);
+		return true;
+	}
+
+	//Consumer side, false if the queue is empty
+	bool pop(T& item){
+		std::size_t head = head_.load(std::memory_order_relaxed);
+		if(head == tail_.load(std::memory_order_acquire)) return false;
+
+		item = items_[head & (Capacity - 1)];
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer side, skips everything but the newest item (for commands where only the latest one matters)
+	bool popLatest(T& item){
+		bool got = false;
+		while(pop(item)) got = true;
+		return got;
+	}
+
+	//Consumer side, sleeps up to timeout_ms for an item (needs setConsumer() from the consuming task)
+	bool popWait(T& item, std::uint32_t timeout_ms){
+		std::uint32_t start = pros::millis();
+
+		while(pop(item) == false){
+			std::uint32_t waited = pros::millis() - start;
+			if(waited >= timeout_ms) return false;
+			pros::Task::notify_take(true, timeout_ms - waited);
+		}
+		return true;
+	}
+
+	//Call from the consuming task before using popWait()
+	void setConsumer(pros::task_t task){
+		consumer_.store(task, std::memory_order_release);
+	}
+
+	std::size_t size() const{
+		return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+	}
+
+	bool empty() const{
+		return size() == 0;
+	}
+
+	//Items the producer couldn't push because the consumer fell behind
+	std::uint32_t dropped() const{
+		return dropped_.load(std::memory_order_relaxed);
+	}
+
+private:
+	T items_[Capacity];
+
+	//Kept on separate cache lines so the producer and consumer don't fight over one
+	alignas(32) std::atomic<std::size_t> head_{0};
+	alignas(32) std::atomic<std::size_t> tail_{0};
+
+	std::atomic<pros::task_t> consumer_{nullptr};
+	std::atomic<std::uint32_t> dropped_{0};
+};
+
+#endif
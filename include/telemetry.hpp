@@ -0,0 +1,47 @@
+#ifndef _TELEMETRY_HPP_
+#define _TELEMETRY_HPP_
+
+#include "spsc_queue.hpp"
+#include "telemetry_codec.hpp"
+
+/*=============
+** TELEMETRY STREAM
+=============*/
+/*Binary telemetry over the USB serial port. A 10 ms scheduler callback samples a TelemetryFrame and
+	record()s it, which is just a queue push, so control never waits on the serial port. A low priority
+	writer task drains the queue every 40 ms, encodes the frames and writes them out in one batch.
+
+	start() turns off the PROS stream multiplexing so our own COBS packets reach the computer unchanged.
+	printf() output still goes through and shows up between packets; tools/telemetry_decode.cpp passes it on
+	as text.*/
+
+#define TELEMETRY_PERIOD_MS 10
+
+//Frames buffered between the sampler and the writer (320 ms at 100 Hz)
+#define TELEMETRY_QUEUE_SIZE 32
+
+//The writer wakes up this often and sends everything queued in one write
+#define TELEMETRY_WRITE_PERIOD_MS 40
+
+//Most frames sent per write (packets are about 40 bytes each once the robot is moving)
+#define TELEMETRY_BATCH_FRAMES 8
+
+class TelemetryStream{
+public:
+	//Starts the writer task
+	void start();
+
+	//Called from the sampling callback only, false if the writer fell behind and the frame was dropped
+	bool record(const TelemetryFrame& frame);
+
+	std::uint32_t dropped() const;
+
+private:
+	static void writerTask(void* stream);
+
+	SpscQueue<TelemetryFrame, TELEMETRY_QUEUE_SIZE> frames_;
+	TelemetryEncoder encoder_;
+	bool started_ = false;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef _TELEMETRY_CODEC_HPP_
+#define _TELEMETRY_CODEC_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/*=============
+** TELEMETRY FRAMES
+=============*/
+/*A telemetry frame is a fixed list of integer fields (the order below is the wire layout, so only ever add
+	fields at the end and bump TELEMETRY_VERSION). On the wire a frame is:
+
+		header (bit 7 key frame, bits 0-6 sequence) | one zigzag varint per field | checksum
+
+	Key frames carry every field as is, the frames in between carry the difference to the frame before, so
+	a robot sitting still costs about one byte per field. The whole thing is COBS encoded and followed by a
+	0 byte, so a reader that starts mid-stream (or sees a printf line) just waits for the next 0.
+
+	This file has no PROS dependencies, the host decoder is built from the same code.*/
+
+#define TELEMETRY_VERSION 2
+
+//One key frame every half second at 100 Hz, so a decoder that drops bytes gets back in sync quickly
+#define TELEMETRY_KEYFRAME_EVERY 50
+
+enum TelemetryField{
+	TLM_TIME,              //ms since the program started
+	TLM_POS_X,             //mm
+	TLM_POS_Y,             //mm
+	TLM_HEADING,           //hundredths of a degree
+	TLM_LEFT_ENCODER,
+	TLM_RIGHT_ENCODER,
+	TLM_CENTER_ENCODER,
+	TLM_TOP_POSITION,      //Feeder positions in encoder degrees
+	TLM_MIDDLE_POSITION,
+	TLM_BALL_SENSOR,
+	TLM_BALL_SENSOR2,
+	TLM_GOAL_SENSOR,
+	TLM_LEFT_FRONT_MV,     //Motor outputs in mV
+	TLM_LEFT_BACK_MV,
+	TLM_RIGHT_FRONT_MV,
+	TLM_RIGHT_BACK_MV,
+	TLM_FEEDER_TOP_MV,
+	TLM_FEEDER_MIDDLE_MV,
+	TLM_LEFT_INTAKE_MV,
+	TLM_RIGHT_INTAKE_MV,
+	TLM_SENSORS_RUN_US,    //Newest run time of the loops that matter most for control
+	TLM_ACTIONS_RUN_US,
+	TLM_DRIVETRAIN_RUN_US,
+	TLM_DRIVE_SCALE,       //Drivetrain derating in percent (100 when the motors are cool)
+	TLM_MAX_TEMPERATURE,   //Hottest motor in C
+	TLM_FIELD_COUNT
+};
+
+struct TelemetryFrame{
+	std::int32_t values[TLM_FIELD_COUNT];
+};
+
+//Column names in field order, for decoders
+extern const char* const TELEMETRY_FIELD_NAMES[TLM_FIELD_COUNT];
+
+//Header + up to 5 varint bytes per field + checksum
+#define TELEMETRY_MAX_RAW_SIZE (1 + 5 * TLM_FIELD_COUNT + 1)
+//COBS adds a byte per 254 bytes (plus one), then the 0 delimiter
+#define TELEMETRY_MAX_PACKET_SIZE (TELEMETRY_MAX_RAW_SIZE + TELEMETRY_MAX_RAW_SIZE / 254 + 2)
+
+//COBS encodes size bytes into out (at least size + size / 254 + 1 bytes), returns the encoded size
+std::size_t cobsEncode(const std::uint8_t* data, std::size_t size, std::uint8_t* out);
+//Decodes one packet without its 0 delimiter, returns the decoded size or 0 if the packet is malformed
+std::size_t cobsDecode(const std::uint8_t* data, std::size_t size, std::uint8_t* out);
+
+class TelemetryEncoder{
+public:
+	//Writes one complete packet (including the 0 delimiter) to out, returns its size
+	std::size_t encode(const TelemetryFrame& frame, std::uint8_t out[TELEMETRY_MAX_PACKET_SIZE]);
+
+private:
+	TelemetryFrame previous_ = {};
+	std::uint8_t sequence_ = 0;
+	int since_key_ = TELEMETRY_KEYFRAME_EVERY;
+};
+
+class TelemetryDecoder{
+public:
+	/*Decodes one packet (without its 0 delimiter) into frame. Returns false for anything that isn't a valid
+		frame, and for delta frames until the next key frame whenever a frame went missing.*/
+	bool decode(const std::uint8_t* packet, std::size_t size, TelemetryFrame& frame);
+
+	//Frames lost to sequence gaps
+	std::uint32_t missed() const;
+
+private:
+	TelemetryFrame previous_ = {};
+	std::uint8_t sequence_ = 0;
+	bool synced_ = false;
+	std::uint32_t missed_ = 0;
+};
+
+#endif
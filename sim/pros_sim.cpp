@@ -0,0 +1,843 @@
+#include "sim.hpp"
+#include "pros/apix.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/*Host implementations of the parts of the PROS API the robot code uses. Devices are plain structs in
+	sim::devices(), the physics in robot.cpp fills in what the sensors read and reads back what the motors
+	were told. Every call returns what PROS would return on success.*/
+
+namespace sim{
+
+Devices& devices(){
+	static Devices state = {};
+	return state;
+}
+
+std::mutex& deviceMutex(){
+	static std::mutex mutex;
+	return mutex;
+}
+
+double maxRpm(pros::motor_gearset_e_t gearset){
+	if(gearset == pros::E_MOTOR_GEARSET_36) return 100;
+	if(gearset == pros::E_MOTOR_GEARSET_06) return 600;
+	return 200;
+}
+
+}
+
+using sim::devices;
+using sim::deviceMutex;
+using sim::maxRpm;
+
+typedef std::lock_guard<std::mutex> DeviceLock;
+
+/*=============
+** RTOS
+=============*/
+namespace pros{
+namespace c{
+
+std::uint32_t millis(){
+	return sim::millis();
+}
+
+std::uint64_t micros(){
+	return sim::micros();
+}
+
+void delay(const std::uint32_t milliseconds){
+	sim::delay(milliseconds);
+}
+
+void task_delay(const std::uint32_t milliseconds){
+	sim::delay(milliseconds);
+}
+
+void task_delay_until(std::uint32_t* const prev_time, const std::uint32_t delta){
+	sim::delayUntil(prev_time, delta);
+}
+
+task_t task_create(task_fn_t function, void* const parameters, std::uint32_t prio, const std::uint16_t, const char* const name){
+	return sim::createTask(function, parameters, prio, name);
+}
+
+task_t task_get_current(){
+	return sim::currentTask();
+}
+
+std::uint32_t task_get_count(){
+	return sim::taskCount();
+}
+
+void task_set_priority(task_t task, std::uint32_t prio){
+	sim::setPriority(task, prio);
+}
+
+std::uint32_t task_notify(task_t task){
+	sim::notify(task);
+	return 1;
+}
+
+std::uint32_t task_notify_take(bool clear_on_exit, std::uint32_t timeout){
+	return sim::notifyTake(clear_on_exit, timeout);
+}
+
+mutex_t mutex_create(){
+	return sim::createMutex();
+}
+
+bool mutex_take(mutex_t mutex, std::uint32_t timeout){
+	return sim::takeMutex(mutex, timeout);
+}
+
+bool mutex_give(mutex_t mutex){
+	return sim::giveMutex(mutex);
+}
+
+void mutex_delete(mutex_t){
+	//Mutexes live as long as the simulation, the robot code only creates them at startup
+}
+
+std::int32_t serctl(const std::uint32_t, void* const){
+	return 1;
+}
+
+}
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name)
+	: task(c::task_create(function, parameters, prio, stack_depth, name)) {}
+
+Task::Task(task_fn_t function, void* parameters, const char* name)
+	: Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {}
+
+Task::Task(task_t task) : task(task) {}
+
+Task Task::current(){
+	return Task(c::task_get_current());
+}
+
+void Task::set_priority(std::uint32_t prio){
+	c::task_set_priority(task, prio);
+}
+
+std::uint32_t Task::notify(){
+	return c::task_notify(task);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout){
+	return c::task_notify_take(clear_on_exit, timeout);
+}
+
+void Task::delay(const std::uint32_t milliseconds){
+	c::task_delay(milliseconds);
+}
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta){
+	c::task_delay_until(prev_time, delta);
+}
+
+std::uint32_t Task::get_count(){
+	return c::task_get_count();
+}
+
+Mutex::Mutex() : mutex(c::mutex_create(), c::mutex_delete) {}
+
+bool Mutex::take(std::uint32_t timeout){
+	return c::mutex_take(mutex.get(), timeout);
+}
+
+bool Mutex::give(){
+	return c::mutex_give(mutex.get());
+}
+
+/*=============
+** MOTORS
+=============*/
+static sim::MotorDevice& motorDevice(std::uint8_t port){
+	return devices().motors[port <= SIM_SMART_PORTS ? port : 0];
+}
+
+Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset, const bool reverse, const motor_encoder_units_e_t)
+	: _port(port){
+	DeviceLock lock (deviceMutex());
+	motorDevice(port).gearset = gearset;
+	motorDevice(port).reversed = reverse;
+	motorDevice(port).temperature = 25;
+}
+
+Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset, const bool reverse)
+	: Motor(port, gearset, reverse, E_MOTOR_ENCODER_DEGREES) {}
+
+Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset)
+	: Motor(port, gearset, false, E_MOTOR_ENCODER_DEGREES) {}
+
+Motor::Motor(const std::uint8_t port, const bool reverse)
+	: Motor(port, E_MOTOR_GEARSET_18, reverse, E_MOTOR_ENCODER_DEGREES) {}
+
+Motor::Motor(const std::uint8_t port)
+	: Motor(port, E_MOTOR_GEARSET_18, false, E_MOTOR_ENCODER_DEGREES) {}
+
+std::int32_t Motor::operator=(std::int32_t voltage) const{
+	return move(voltage);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const{
+	//Not the virtual move_voltage(): on the brain move() goes straight to the device, a subclass's override never sees it
+	return Motor::move_voltage(voltage * 12000 / 127);
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const{
+	DeviceLock lock (deviceMutex());
+	sim::MotorDevice& motor = motorDevice(_port);
+	std::int32_t clamped = std::clamp(voltage, -12000, 12000);
+	motor.voltage = motor.reversed ? -clamped : clamped;
+	motor.position_mode = false;
+	return 1;
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const{
+	double rpm;
+	{
+		DeviceLock lock (deviceMutex());
+		rpm = maxRpm(motorDevice(_port).gearset);
+	}
+	//Open loop, the internal velocity PID is close enough to ideal for the simulation
+	return Motor::move_voltage(velocity * 12000 / rpm);
+}
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const{
+	DeviceLock lock (deviceMutex());
+	sim::MotorDevice& motor = motorDevice(_port);
+	double target = motor.zero + (motor.reversed ? -position : position);
+	motor.position_mode = true;
+	motor.target_position = target;
+	motor.target_velocity = std::abs(velocity);
+	return 1;
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const{
+	double current;
+	{
+		DeviceLock lock (deviceMutex());
+		const sim::MotorDevice& motor = motorDevice(_port);
+		current = motor.position_mode ? motor.target_position : motor.position;
+		current = motor.reversed ? -(current - motor.zero) : current - motor.zero;
+	}
+	return move_absolute(current + position, velocity);
+}
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const{
+	DeviceLock lock (deviceMutex());
+	motorDevice(_port).target_velocity = std::abs(velocity);
+	return 1;
+}
+
+double Motor::get_target_position() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	double target = motor.target_position - motor.zero;
+	return motor.reversed ? -target : target;
+}
+
+std::int32_t Motor::get_target_velocity() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).target_velocity;
+}
+
+double Motor::get_actual_velocity() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	return motor.reversed ? -motor.velocity : motor.velocity;
+}
+
+std::int32_t Motor::get_current_draw() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).current;
+}
+
+std::int32_t Motor::get_direction() const{
+	return get_actual_velocity() < 0 ? -1 : 1;
+}
+
+double Motor::get_efficiency() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	if(motor.voltage == 0) return 0;
+	return std::min(100.0, 100 * std::abs(motor.velocity / maxRpm(motor.gearset)) / (std::abs(motor.voltage) / 12000.0));
+}
+
+std::int32_t Motor::is_over_current() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).current > 2400;
+}
+
+std::int32_t Motor::is_stopped() const{
+	DeviceLock lock (deviceMutex());
+	return std::abs(motorDevice(_port).velocity) < 1;
+}
+
+std::int32_t Motor::get_zero_position_flag() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	return motor.position == motor.zero;
+}
+
+std::uint32_t Motor::get_faults() const{
+	std::uint32_t faults = 0;
+	if(is_over_temp()) faults |= E_MOTOR_FAULT_MOTOR_OVER_TEMP;
+	if(is_over_current()) faults |= E_MOTOR_FAULT_OVER_CURRENT;
+	return faults;
+}
+
+std::uint32_t Motor::get_flags() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	return motor.position_mode && std::abs(motor.target_position - motor.position) > 5 ? E_MOTOR_FLAGS_BUSY : 0;
+}
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp) const{
+	if(timestamp != nullptr) *timestamp = sim::millis();
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).position;
+}
+
+std::int32_t Motor::is_over_temp() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).temperature >= 55;
+}
+
+double Motor::get_position() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	double position = motor.position - motor.zero;
+	return motor.reversed ? -position : position;
+}
+
+double Motor::get_power() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	return std::abs(motor.voltage) / 1000.0 * motor.current / 1000.0;
+}
+
+double Motor::get_temperature() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).temperature;
+}
+
+double Motor::get_torque() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).torque;
+}
+
+std::int32_t Motor::get_voltage() const{
+	DeviceLock lock (deviceMutex());
+	const sim::MotorDevice& motor = motorDevice(_port);
+	return motor.reversed ? -motor.voltage : motor.voltage;
+}
+
+std::int32_t Motor::set_zero_position(const double position) const{
+	DeviceLock lock (deviceMutex());
+	sim::MotorDevice& motor = motorDevice(_port);
+	motor.zero = motor.position - (motor.reversed ? -position : position);
+	return 1;
+}
+
+std::int32_t Motor::tare_position() const{
+	return set_zero_position(0);
+}
+
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode) const{
+	DeviceLock lock (deviceMutex());
+	motorDevice(_port).brake_mode = mode;
+	return 1;
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t) const{
+	return 1;
+}
+
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t) const{
+	//Always degrees in the simulation
+	return 1;
+}
+
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset) const{
+	DeviceLock lock (deviceMutex());
+	motorDevice(_port).gearset = gearset;
+	return 1;
+}
+
+std::int32_t Motor::set_pos_pid(const motor_pid_s_t) const{
+	return 1;
+}
+
+std::int32_t Motor::set_pos_pid_full(const motor_pid_full_s_t) const{
+	return 1;
+}
+
+std::int32_t Motor::set_vel_pid(const motor_pid_s_t) const{
+	return 1;
+}
+
+std::int32_t Motor::set_vel_pid_full(const motor_pid_full_s_t) const{
+	return 1;
+}
+
+std::int32_t Motor::set_reversed(const bool reverse) const{
+	DeviceLock lock (deviceMutex());
+	motorDevice(_port).reversed = reverse;
+	return 1;
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t) const{
+	return 1;
+}
+
+motor_brake_mode_e_t Motor::get_brake_mode() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).brake_mode;
+}
+
+std::int32_t Motor::get_current_limit() const{
+	return 2500;
+}
+
+motor_encoder_units_e_t Motor::get_encoder_units() const{
+	return E_MOTOR_ENCODER_DEGREES;
+}
+
+motor_gearset_e_t Motor::get_gearing() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).gearset;
+}
+
+motor_pid_full_s_t Motor::get_pos_pid() const{
+	return motor_pid_full_s_t {};
+}
+
+motor_pid_full_s_t Motor::get_vel_pid() const{
+	return motor_pid_full_s_t {};
+}
+
+std::int32_t Motor::is_reversed() const{
+	DeviceLock lock (deviceMutex());
+	return motorDevice(_port).reversed;
+}
+
+std::int32_t Motor::get_voltage_limit() const{
+	return 0;
+}
+
+std::uint8_t Motor::get_port() const{
+	return _port;
+}
+
+/*=============
+** INERTIAL SENSOR
+=============*/
+//A reset takes this long on the real sensor
+#define SIM_IMU_CALIBRATION_MS 2000
+
+static sim::ImuDevice& imuDevice(std::uint8_t port){
+	return devices().imus[port <= SIM_SMART_PORTS ? port : 0];
+}
+
+//Heading in [0, 360) as the sensor reports it
+static double wrapHeading(double heading){
+	heading = std::fmod(heading, 360);
+	return heading < 0 ? heading + 360 : heading;
+}
+
+std::int32_t Imu::reset() const{
+	DeviceLock lock (deviceMutex());
+	sim::ImuDevice& imu = imuDevice(_port);
+	imu.calibrated_at = sim::millis() + SIM_IMU_CALIBRATION_MS;
+	imu.offset = imu.heading;
+	return 1;
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t) const{
+	return 1;
+}
+
+double Imu::get_rotation() const{
+	DeviceLock lock (deviceMutex());
+	const sim::ImuDevice& imu = imuDevice(_port);
+	return imu.heading - imu.offset;
+}
+
+double Imu::get_heading() const{
+	return wrapHeading(get_rotation());
+}
+
+pros::c::quaternion_s_t Imu::get_quaternion() const{
+	double half = -get_yaw() * M_PI / 360;
+	pros::c::quaternion_s_t quaternion = {};
+	quaternion.z = std::sin(half);
+	quaternion.w = std::cos(half);
+	return quaternion;
+}
+
+pros::c::euler_s_t Imu::get_euler() const{
+	pros::c::euler_s_t euler = {};
+	euler.yaw = get_yaw();
+	return euler;
+}
+
+double Imu::get_pitch() const{
+	return 0;
+}
+
+double Imu::get_roll() const{
+	return 0;
+}
+
+double Imu::get_yaw() const{
+	double heading = get_heading();
+	return heading > 180 ? heading - 360 : heading;
+}
+
+pros::c::imu_gyro_s_t Imu::get_gyro_rate() const{
+	DeviceLock lock (deviceMutex());
+	pros::c::imu_gyro_s_t rate = {};
+	rate.z = imuDevice(_port).rate;
+	return rate;
+}
+
+std::int32_t Imu::tare_rotation() const{
+	return set_rotation(0);
+}
+
+std::int32_t Imu::tare_heading() const{
+	return set_heading(0);
+}
+
+std::int32_t Imu::tare_pitch() const{
+	return 1;
+}
+
+std::int32_t Imu::tare_yaw() const{
+	return set_yaw(0);
+}
+
+std::int32_t Imu::tare_roll() const{
+	return 1;
+}
+
+std::int32_t Imu::tare() const{
+	return set_rotation(0);
+}
+
+std::int32_t Imu::tare_euler() const{
+	return set_yaw(0);
+}
+
+std::int32_t Imu::set_heading(const double target) const{
+	return set_rotation(target);
+}
+
+std::int32_t Imu::set_rotation(const double target) const{
+	DeviceLock lock (deviceMutex());
+	sim::ImuDevice& imu = imuDevice(_port);
+	imu.offset = imu.heading - target;
+	return 1;
+}
+
+std::int32_t Imu::set_yaw(const double target) const{
+	return set_rotation(target);
+}
+
+std::int32_t Imu::set_pitch(const double) const{
+	return 1;
+}
+
+std::int32_t Imu::set_roll(const double) const{
+	return 1;
+}
+
+std::int32_t Imu::set_euler(const pros::c::euler_s_t target) const{
+	return set_yaw(target.yaw);
+}
+
+pros::c::imu_accel_s_t Imu::get_accel() const{
+	pros::c::imu_accel_s_t accel = {};
+	accel.z = 1;
+	return accel;
+}
+
+pros::c::imu_status_e_t Imu::get_status() const{
+	return is_calibrating() ? pros::c::E_IMU_STATUS_CALIBRATING : (pros::c::imu_status_e_t)0;
+}
+
+bool Imu::is_calibrating() const{
+	DeviceLock lock (deviceMutex());
+	return sim::millis() < imuDevice(_port).calibrated_at;
+}
+
+/*=============
+** ADI
+=============*/
+//Ports may be given as 1-8 or 'A'-'H'
+static std::uint8_t adiIndex(std::uint8_t adi_port){
+	if(adi_port >= 'a' && adi_port <= 'h') return adi_port - 'a' + 1;
+	if(adi_port >= 'A' && adi_port <= 'H') return adi_port - 'A' + 1;
+	return adi_port <= SIM_ADI_PORTS ? adi_port : 0;
+}
+
+static sim::AdiDevice& adiDevice(std::uint8_t smart_port, std::uint8_t adi_port){
+	return devices().adi[smart_port <= SIM_SMART_PORTS ? smart_port : 0][adi_port];
+}
+
+ADIPort::ADIPort(std::uint8_t adi_port, adi_port_config_e_t)
+	: _smart_port(SIM_BRAIN_ADI), _adi_port(adiIndex(adi_port)) {}
+
+ADIPort::ADIPort(ext_adi_port_pair_t port_pair, adi_port_config_e_t)
+	: _smart_port(port_pair.first), _adi_port(adiIndex(port_pair.second)) {}
+
+std::int32_t ADIPort::get_value() const{
+	DeviceLock lock (deviceMutex());
+	return adiDevice(_smart_port, _adi_port).value;
+}
+
+ADIAnalogIn::ADIAnalogIn(std::uint8_t adi_port) : ADIPort(adi_port, E_ADI_ANALOG_IN) {}
+
+ADIAnalogIn::ADIAnalogIn(ext_adi_port_pair_t port_pair) : ADIPort(port_pair, E_ADI_ANALOG_IN) {}
+
+//calibrate() averages the input for this long, blocking the caller
+#define SIM_ADI_CALIBRATION_MS 500
+
+std::int32_t ADIAnalogIn::calibrate() const{
+	sim::delay(SIM_ADI_CALIBRATION_MS);
+
+	DeviceLock lock (deviceMutex());
+	sim::AdiDevice& adi = adiDevice(_smart_port, _adi_port);
+	adi.calibration = adi.value;
+	return adi.calibration;
+}
+
+std::int32_t ADIAnalogIn::get_value_calibrated() const{
+	DeviceLock lock (deviceMutex());
+	const sim::AdiDevice& adi = adiDevice(_smart_port, _adi_port);
+	return adi.value - adi.calibration;
+}
+
+std::int32_t ADIAnalogIn::get_value_calibrated_HR() const{
+	return get_value_calibrated() * 16;
+}
+
+ADIEncoder::ADIEncoder(std::uint8_t adi_port_top, std::uint8_t, bool reversed)
+	: ADIPort(adi_port_top, E_ADI_LEGACY_ENCODER){
+	DeviceLock lock (deviceMutex());
+	adiDevice(_smart_port, _adi_port).reversed = reversed;
+}
+
+ADIEncoder::ADIEncoder(ext_adi_port_tuple_t port_tuple, bool reversed)
+	: ADIPort({std::get<0>(port_tuple), std::get<1>(port_tuple)}, E_ADI_LEGACY_ENCODER){
+	DeviceLock lock (deviceMutex());
+	adiDevice(_smart_port, _adi_port).reversed = reversed;
+}
+
+std::int32_t ADIEncoder::reset() const{
+	DeviceLock lock (deviceMutex());
+	sim::AdiDevice& adi = adiDevice(_smart_port, _adi_port);
+	adi.encoder_offset = std::lround(adi.ticks);
+	return 1;
+}
+
+std::int32_t ADIEncoder::get_value() const{
+	DeviceLock lock (deviceMutex());
+	const sim::AdiDevice& adi = adiDevice(_smart_port, _adi_port);
+	std::int32_t count = std::lround(adi.ticks) - adi.encoder_offset;
+	return adi.reversed ? -count : count;
+}
+
+/*=============
+** VISION SENSOR
+=============*/
+Vision::Vision(std::uint8_t port, vision_zero_e_t) : _port(port) {}
+
+vision_signature_s_t Vision::signature_from_utility(const std::int32_t id, const std::int32_t u_min, const std::int32_t u_max, const std::int32_t u_mean,
+		const std::int32_t v_min, const std::int32_t v_max, const std::int32_t v_mean, const float range, const std::int32_t type){
+	vision_signature_s_t signature = {};
+	signature.id = id;
+	signature.range = range;
+	signature.u_min = u_min;
+	signature.u_max = u_max;
+	signature.u_mean = u_mean;
+	signature.v_min = v_min;
+	signature.v_max = v_max;
+	signature.v_mean = v_mean;
+	signature.type = type;
+	return signature;
+}
+
+std::int32_t Vision::set_signature(const std::uint8_t, vision_signature_s_t* const) const{
+	return 1;
+}
+
+//Blobs come out largest first like on the sensor, unused slots get VISION_OBJECT_ERR_SIG
+std::int32_t Vision::read_by_sig(const std::uint32_t size_id, const std::uint32_t sig_id, const std::uint32_t object_count, vision_object_s_t* const object_arr) const{
+	sim::VisionBlob blobs[SIM_MAX_BLOBS];
+	int count = 0;
+	{
+		DeviceLock lock (deviceMutex());
+		for(int i = 0; i < devices().blob_count; i++){
+			if(devices().blobs[i].signature == sig_id) blobs[count++] = devices().blobs[i];
+		}
+	}
+	std::stable_sort(blobs, blobs + count, [](const sim::VisionBlob& a, const sim::VisionBlob& b){
+		return a.width * a.height > b.width * b.height;
+	});
+
+	std::uint32_t found = 0;
+	for(std::uint32_t i = 0; i < object_count; i++){
+		vision_object_s_t& object = object_arr[i];
+		object = vision_object_s_t {};
+		object.signature = VISION_OBJECT_ERR_SIG;
+
+		int index = size_id + i;
+		if(index >= count) continue;
+		const sim::VisionBlob& blob = blobs[index];
+		object.signature = blob.signature;
+		object.x_middle_coord = blob.x;
+		object.y_middle_coord = blob.y;
+		object.left_coord = blob.x - blob.width / 2;
+		object.top_coord = blob.y - blob.height / 2;
+		object.width = blob.width;
+		object.height = blob.height;
+		found += 1;
+	}
+	return found;
+}
+
+/*=============
+** CONTROLLER
+=============*/
+Controller::Controller(controller_id_e_t id) : _id(id) {}
+
+std::int32_t Controller::is_connected(){
+	return 1;
+}
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel){
+	if(channel < 0 || channel > E_CONTROLLER_ANALOG_RIGHT_Y) return 0;
+	DeviceLock lock (deviceMutex());
+	return devices().controller.analog[channel];
+}
+
+std::int32_t Controller::get_digital(controller_digital_e_t button){
+	int index = button - E_CONTROLLER_DIGITAL_L1;
+	if(index < 0 || index >= 12) return 0;
+	DeviceLock lock (deviceMutex());
+	return devices().controller.digital[index];
+}
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button){
+	int index = button - E_CONTROLLER_DIGITAL_L1;
+	if(index < 0 || index >= 12) return 0;
+	DeviceLock lock (deviceMutex());
+	sim::ControllerDevice& controller = devices().controller;
+	if(controller.digital[index] == false){
+		controller.reported[index] = false;
+		return 0;
+	}
+	if(controller.reported[index]) return 0;
+	controller.reported[index] = true;
+	return 1;
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const char* str){
+	if(line > 2 || col > 14) return 0;
+	DeviceLock lock (deviceMutex());
+	char* text = devices().controller.text[line];
+	std::strncpy(text + col, str, sizeof(devices().controller.text[line]) - 1 - col);
+	return 1;
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const std::string& str){
+	return set_text(line, col, str.c_str());
+}
+
+std::int32_t Controller::clear_line(std::uint8_t line){
+	if(line > 2) return 0;
+	DeviceLock lock (deviceMutex());
+	std::memset(devices().controller.text[line], 0, sizeof(devices().controller.text[line]));
+	return 1;
+}
+
+std::int32_t Controller::clear(){
+	for(std::uint8_t line = 0; line < 3; line++) clear_line(line);
+	return 1;
+}
+
+std::int32_t Controller::rumble(const char* rumble_pattern){
+	DeviceLock lock (deviceMutex());
+	std::strncpy(devices().controller.rumble, rumble_pattern, sizeof(devices().controller.rumble) - 1);
+	return 1;
+}
+
+/*=============
+** BRAIN
+=============*/
+namespace c{
+
+bool lcd_set_text(std::int16_t line, const char* text){
+	if(line < 0 || line >= 8) return false;
+	DeviceLock lock (deviceMutex());
+	std::strncpy(devices().lcd[line], text, sizeof(devices().lcd[line]) - 1);
+	return true;
+}
+
+}
+
+namespace lcd{
+
+bool initialize(){
+	return true;
+}
+
+bool is_initialized(){
+	return true;
+}
+
+bool set_text(std::int16_t line, std::string text){
+	return c::lcd_set_text(line, text.c_str());
+}
+
+bool clear_line(std::int16_t line){
+	return c::lcd_set_text(line, "");
+}
+
+}
+
+namespace competition{
+
+std::uint8_t is_autonomous(){
+	DeviceLock lock (deviceMutex());
+	return devices().autonomous;
+}
+
+std::uint8_t is_disabled(){
+	DeviceLock lock (deviceMutex());
+	return devices().disabled;
+}
+
+std::uint8_t is_connected(){
+	return 0;
+}
+
+}
+
+namespace usd{
+
+std::int32_t is_installed(){
+	DeviceLock lock (deviceMutex());
+	return devices().sd_card;
+}
+
+}
+
+}
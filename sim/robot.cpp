@@ -0,0 +1,459 @@
+#include "robot.hpp"
+#include "ports.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace sim{
+
+/*=============
+** CONSTANTS
+=============*/
+//Motor response: time constants in s for driven, hold, brake and coast
+#define MOTOR_TAU 0.08
+#define MOTOR_HOLD_TAU 0.03
+#define MOTOR_BRAKE_TAU 0.06
+#define MOTOR_COAST_TAU 0.4
+#define MOTOR_MAX_CURRENT 2500
+#define MOTOR_STALL_TORQUE 2.1
+//Temperature rise per s at full current and cooling per s per degree above ambient
+#define MOTOR_HEATING 1.0
+#define MOTOR_COOLING 0.01
+#define MOTOR_AMBIENT 25
+//Proportional gain (mV per degree) for move_absolute()
+#define MOTOR_POSITION_KP 40
+
+//3.25" omni wheels on 200 RPM motors, 2.75" tracking wheels at 360 ticks a turn
+//Robot speed per wheel RPM (the X-drive gets sqrt(2) of the wheel speed)
+#define DRIVE_TICKS_PER_RPM_S 10.03
+//Turn rate per wheel RPM, wheels 8" from the centre
+#define DRIVE_DEG_PER_RPM_S 1.219
+//Tracking wheels are 6" either side of the centre
+#define TRACKING_HALF_WIDTH 250
+
+//Field walls for the robot's centre
+#define FIELD_MIN_X -1500
+#define FIELD_MAX_X 4350
+#define FIELD_MIN_Y -450
+#define FIELD_MAX_Y 5200
+
+/*Conveyer positions are in roller degrees. The middle roller carries balls from the intake (0) up to the top
+	roller (CONVEYER_TOP); the top roller then carries one ball forward into the goal or backwards out of the
+	robot (TOP_EXIT either way).*/
+#define CONVEYER_TOP 600
+#define CONVEYER_SPACING 250
+#define CONVEYER_INTAKE_END 150
+#define TOP_EXIT 400
+#define BALL_THROW 300
+
+//Sensor windows and the readings the robot code expects
+#define TOP_SENSOR_MIN -100
+#define TOP_SENSOR_MAX 250
+#define MIDDLE_SENSOR_MIN 330
+#define MIDDLE_SENSOR_MAX 520
+#define TOP_SENSOR_BALL 2500
+#define TOP_SENSOR_EMPTY 20
+#define MIDDLE_SENSOR_BALL 2800
+#define MIDDLE_SENSOR_EMPTY 300
+#define GOAL_SENSOR_GOAL 100
+#define GOAL_SENSOR_EMPTY 4000
+#define GOAL_SENSOR_RANGE 150
+
+//A field ball this far in front of (and beside) the centre is taken in by a running intake
+#define INTAKE_MIN_FORWARD -50
+#define INTAKE_MAX_FORWARD 280
+#define INTAKE_HALF_WIDTH 150
+#define INTAKE_MIN_RPM 20
+
+//Vision sensor on the front of the robot, 316 x 212 px, 61 degrees wide
+#define VISION_MIN_DISTANCE 50
+#define VISION_MAX_DISTANCE 1200
+#define VISION_HALF_FOV 30.5
+#define VISION_WIDTH 316
+#define VISION_HEIGHT 212
+#define VISION_BALL_SIZE 9000
+//Signatures the robot code sets up for each colour
+#define VISION_RED_SIG 1
+#define VISION_BLUE_SIG 2
+
+#define DEG_TO_RAD (M_PI / 180)
+
+namespace{
+
+/*=============
+** FIELD
+=============*/
+//Goals sit where the autonomous routine's goal sensor drives end
+const double GOALS[SIM_GOAL_COUNT][2] = {
+	{-1100, 100}, {-1400, 2570}, {-1120, 5070},
+	{1610, -300}, {1500, 2550}, {1560, 4900},
+	{4220, 0}, {4210, 2580}, {4000, 5000},
+};
+
+//Balls along the routine's intake drives, approximate
+const double RED_BALLS[][2] = {
+	{-720, 300}, {-510, 1840}, {-690, 4640}, {-220, 2815}, {1570, 4300},
+	{3280, 4300}, {3580, 3235}, {2280, 1630}, {1610, 400}, {3550, 945},
+};
+const double BLUE_BALLS[][2] = {
+	{-570, 520}, {-800, 4450}, {900, 3190}, {2910, 750},
+};
+
+RobotState state;
+
+/*=============
+** NOISE
+=============*/
+//Biases drawn for the run by setNoise()
+struct NoiseState{
+	Noise noise;
+	std::mt19937 random;
+	double encoder_scale[3] = {1, 1, 1};   //Left, right, center
+	double imu_drift = 0;
+	double slip = 0;
+	double sag = 0;
+	double elapsed = 0;
+};
+
+NoiseState noise_state;
+
+//Neither draws when the noise is off, so a run without noise doesn't depend on the seed
+double gaussian(double deviation){
+	if(deviation == 0) return 0;
+	return std::normal_distribution<double>(0, deviation)(noise_state.random);
+}
+
+double uniform(double high){
+	if(high == 0) return 0;
+	return std::uniform_real_distribution<double>(0, high)(noise_state.random);
+}
+
+double trackingTicks(int wheel, double travel){
+	return travel * noise_state.encoder_scale[wheel] + gaussian(noise_state.noise.encoder_jitter * std::abs(travel));
+}
+
+std::int32_t analogReading(double value){
+	if(noise_state.noise.sensor_jitter == 0) return value;
+	return std::clamp((int)std::lround(value + gaussian(noise_state.noise.sensor_jitter)), 0, 4095);
+}
+
+/*=============
+** MOTORS
+=============*/
+void stepMotor(MotorDevice& motor, double dt){
+	double max_rpm = maxRpm(motor.gearset);
+
+	double voltage = motor.voltage;
+	if(motor.position_mode){
+		double limit = motor.target_velocity * 12000.0 / max_rpm;
+		voltage = std::clamp((motor.target_position - motor.position) * MOTOR_POSITION_KP, -limit, limit);
+	}
+
+	//A sagging battery can't deliver what the code asks for
+	voltage *= 1 - noise_state.sag * std::min(1.0, noise_state.elapsed / 60);
+
+	double target = voltage / 12000 * max_rpm;
+	double tau = MOTOR_TAU;
+	if(voltage == 0){
+		if(motor.brake_mode == pros::E_MOTOR_BRAKE_HOLD) tau = MOTOR_HOLD_TAU;
+		else if(motor.brake_mode == pros::E_MOTOR_BRAKE_BRAKE) tau = MOTOR_BRAKE_TAU;
+		else tau = MOTOR_COAST_TAU;
+	}
+
+	motor.velocity += (target - motor.velocity) * std::min(1.0, dt / tau);
+	motor.position += motor.velocity * 6 * dt;
+
+	//Current follows how far the motor is from where the voltage wants it
+	double load = std::min(1.0, std::abs(target - motor.velocity) / max_rpm + (voltage != 0 ? 0.05 : 0));
+	motor.current = load * MOTOR_MAX_CURRENT;
+	motor.torque = load * MOTOR_STALL_TORQUE;
+	motor.temperature += (load * load * MOTOR_HEATING - (motor.temperature - MOTOR_AMBIENT) * MOTOR_COOLING) * dt;
+}
+
+/*=============
+** DRIVE
+=============*/
+void stepDrive(Devices& devices, double dt){
+	double left_front = devices.motors[LEFT_WHEEL_FRONT_PORT].velocity;
+	double left_back = devices.motors[LEFT_WHEEL_BACK_PORT].velocity;
+	double right_front = devices.motors[RIGHT_WHEEL_FRONT_PORT].velocity;
+	double right_back = devices.motors[RIGHT_WHEEL_BACK_PORT].velocity;
+
+	//Inverse of front = f + s + t, left back = f - s + t, right front = -f + s + t, right back = -f - s + t
+	double forward = (left_front + left_back - right_front - right_back) / 4;
+	double strafe = (left_front - left_back + right_front - right_back) / 4;
+	double turn = (left_front + left_back + right_front + right_back) / 4;
+
+	state.forward_speed = forward * DRIVE_TICKS_PER_RPM_S;
+	state.strafe_speed = strafe * DRIVE_TICKS_PER_RPM_S;
+	state.turn_rate = turn * DRIVE_DEG_PER_RPM_S;
+
+	//Slipping wheels lose some of the motion they ask for
+	if(noise_state.slip > 0){
+		double grip = 1 - uniform(noise_state.slip);
+		state.forward_speed *= grip;
+		state.strafe_speed *= grip;
+		state.turn_rate *= grip;
+	}
+
+	Pose& pose = state.pose;
+	double turned = state.turn_rate * dt;
+	double angle = (pose.heading + turned / 2) * DEG_TO_RAD;
+
+	double x = pose.x + (state.forward_speed * std::sin(angle) + state.strafe_speed * std::cos(angle)) * dt;
+	double y = pose.y + (state.forward_speed * std::cos(angle) - state.strafe_speed * std::sin(angle)) * dt;
+	x = std::clamp(x, (double)FIELD_MIN_X, (double)FIELD_MAX_X);
+	y = std::clamp(y, (double)FIELD_MIN_Y, (double)FIELD_MAX_Y);
+
+	//Tracking wheels see what the robot actually did, so pushing on a wall doesn't count
+	double dx = x - pose.x;
+	double dy = y - pose.y;
+	double moved_forward = dx * std::sin(angle) + dy * std::cos(angle);
+	double moved_strafe = dx * std::cos(angle) - dy * std::sin(angle);
+	double turn_travel = turned * DEG_TO_RAD * TRACKING_HALF_WIDTH;
+
+	devices.adi[SIM_BRAIN_ADI][LEFT_ENCODER_TOP].ticks += trackingTicks(0, moved_forward + turn_travel);
+	devices.adi[SIM_BRAIN_ADI][RIGHT_ENCODER_TOP].ticks += trackingTicks(1, moved_forward - turn_travel);
+	devices.adi[SIM_BRAIN_ADI][CENTER_ENCODER_TOP].ticks += trackingTicks(2, moved_strafe);
+
+	pose.x = x;
+	pose.y = y;
+	pose.heading = std::fmod(pose.heading + turned + 360, 360);
+
+	devices.imus[IMU_PORT].heading += turned + noise_state.imu_drift * dt;
+	devices.imus[IMU_PORT].rate = state.turn_rate + noise_state.imu_drift;
+}
+
+/*=============
+** BALLS
+=============*/
+//Field position relative to the robot: forward and to the right of its centre
+void relative(const Pose& pose, double x, double y, double& forward, double& right){
+	double angle = pose.heading * DEG_TO_RAD;
+	forward = (x - pose.x) * std::sin(angle) + (y - pose.y) * std::cos(angle);
+	right = (x - pose.x) * std::cos(angle) - (y - pose.y) * std::sin(angle);
+}
+
+//Goal in reach of the goal sensor, -1 if none
+int goalInReach(const Pose& pose){
+	for(int i = 0; i < SIM_GOAL_COUNT; i++){
+		if(std::hypot(GOALS[i][0] - pose.x, GOALS[i][1] - pose.y) < GOAL_SENSOR_RANGE) return i;
+	}
+	return -1;
+}
+
+//Drops a ball on the field this far in front of the robot (negative is behind)
+void dropBall(Ball& ball, double distance){
+	double angle = state.pose.heading * DEG_TO_RAD;
+	ball.state = BALL_ON_FIELD;
+	ball.x = state.pose.x + distance * std::sin(angle);
+	ball.y = state.pose.y + distance * std::cos(angle);
+}
+
+void stepBalls(Devices& devices, double dt){
+	double middle_travel = -devices.motors[FEEDER_MIDDLE_PORT].velocity * 6 * dt;
+	double top_travel = -devices.motors[FEEDER_TOP_PORT].velocity * 6 * dt;
+	double intake_rpm = (devices.motors[LEFT_INTAKE_PORT].velocity - devices.motors[RIGHT_INTAKE_PORT].velocity) / 2;
+	double intake_travel = intake_rpm * 6 * dt;
+
+	//Top roller first, a ball leaving it makes room for the next one
+	Ball* top = nullptr;
+	for(int i = 0; i < state.ball_count; i++){
+		Ball& ball = state.balls[i];
+		if(ball.state != BALL_IN_TOP) continue;
+
+		ball.position += top_travel;
+		if(ball.position >= TOP_EXIT){
+			int goal = goalInReach(state.pose);
+			if(goal >= 0){
+				ball.state = BALL_SCORED;
+				ball.goal = goal;
+				ball.scored_at = millis();
+				if(ball.red) state.scored += 1;
+				else state.scored_theirs += 1;
+			}
+			else{
+				dropBall(ball, BALL_THROW);
+			}
+		}
+		else if(ball.position <= -TOP_EXIT){
+			dropBall(ball, -BALL_THROW);
+			state.ejected += 1;
+		}
+		else{
+			top = &ball;
+		}
+	}
+
+	//Then the conveyer from the top down, each ball stops short of the one above it
+	Ball* conveyer[SIM_MAX_BALLS];
+	int count = 0;
+	for(int i = 0; i < state.ball_count; i++){
+		if(state.balls[i].state == BALL_IN_CONVEYER) conveyer[count++] = &state.balls[i];
+	}
+	std::sort(conveyer, conveyer + count, [](const Ball* a, const Ball* b){ return a->position > b->position; });
+
+	double limit = top != nullptr ? CONVEYER_TOP - CONVEYER_SPACING : CONVEYER_TOP;
+	for(int i = 0; i < count; i++){
+		Ball& ball = *conveyer[i];
+		double travel = middle_travel;
+		if(ball.position < CONVEYER_INTAKE_END) travel = std::max(travel, intake_travel);
+		ball.position = std::min(ball.position + travel, limit);
+
+		if(ball.position >= CONVEYER_TOP && top == nullptr){
+			ball.state = BALL_IN_TOP;
+			ball.position = 0;
+			top = &ball;
+			limit = CONVEYER_TOP - CONVEYER_SPACING;
+			continue;
+		}
+		if(ball.position < 0){
+			//Spat back out by a reversed intake
+			if(intake_rpm < -INTAKE_MIN_RPM){
+				dropBall(ball, INTAKE_MAX_FORWARD + 50);
+				continue;
+			}
+			ball.position = 0;
+		}
+		limit = ball.position - CONVEYER_SPACING;
+	}
+
+	//Intake picks up field balls when the bottom of the conveyer is free
+	double lowest = 1e9;
+	for(int i = 0; i < state.ball_count; i++){
+		if(state.balls[i].state == BALL_IN_CONVEYER) lowest = std::min(lowest, state.balls[i].position);
+	}
+	if(intake_rpm > INTAKE_MIN_RPM && lowest >= CONVEYER_SPACING){
+		for(int i = 0; i < state.ball_count; i++){
+			Ball& ball = state.balls[i];
+			if(ball.state != BALL_ON_FIELD) continue;
+
+			double forward, right;
+			relative(state.pose, ball.x, ball.y, forward, right);
+			if(forward < INTAKE_MIN_FORWARD || forward > INTAKE_MAX_FORWARD || std::abs(right) > INTAKE_HALF_WIDTH) continue;
+
+			ball.state = BALL_IN_CONVEYER;
+			ball.position = 0;
+			break;
+		}
+	}
+}
+
+/*=============
+** SENSORS
+=============*/
+void updateSensors(Devices& devices){
+	bool top_ball = false;
+	bool middle_ball = false;
+	for(int i = 0; i < state.ball_count; i++){
+		const Ball& ball = state.balls[i];
+		if(ball.state == BALL_IN_TOP && ball.position >= TOP_SENSOR_MIN && ball.position <= TOP_SENSOR_MAX) top_ball = true;
+		if(ball.state == BALL_IN_CONVEYER && ball.position >= MIDDLE_SENSOR_MIN && ball.position <= MIDDLE_SENSOR_MAX) middle_ball = true;
+	}
+
+	devices.adi[SIM_BRAIN_ADI][ANALOG_SENSOR_PORT2].value = analogReading(top_ball ? TOP_SENSOR_BALL : TOP_SENSOR_EMPTY);
+	devices.adi[ANALOG_SENSOR_PORT3][1].value = analogReading(middle_ball ? MIDDLE_SENSOR_BALL : MIDDLE_SENSOR_EMPTY);
+	devices.adi[SIM_BRAIN_ADI][ANALOG_SENSOR_PORT1].value = analogReading(goalInReach(state.pose) >= 0 ? GOAL_SENSOR_GOAL : GOAL_SENSOR_EMPTY);
+
+	//Vision blobs, bigger and lower in the frame the closer the ball is
+	devices.blob_count = 0;
+	for(int i = 0; i < state.ball_count && devices.blob_count < SIM_MAX_BLOBS; i++){
+		const Ball& ball = state.balls[i];
+		if(ball.state != BALL_ON_FIELD) continue;
+
+		double forward, right;
+		relative(state.pose, ball.x, ball.y, forward, right);
+		if(forward < VISION_MIN_DISTANCE || forward > VISION_MAX_DISTANCE) continue;
+		double bearing = std::atan2(right, forward) / DEG_TO_RAD;
+		if(std::abs(bearing) > VISION_HALF_FOV) continue;
+
+		VisionBlob& blob = devices.blobs[devices.blob_count++];
+		double size = std::min(120.0, VISION_BALL_SIZE / forward);
+		double bottom = VISION_HEIGHT - (forward - VISION_MIN_DISTANCE) / (VISION_MAX_DISTANCE - VISION_MIN_DISTANCE) * 180;
+		blob.signature = ball.red ? VISION_RED_SIG : VISION_BLUE_SIG;
+		blob.x = VISION_WIDTH / 2 + bearing / VISION_HALF_FOV * VISION_WIDTH / 2;
+		blob.y = bottom - size / 2;
+		blob.width = size;
+		blob.height = size;
+	}
+}
+
+}
+
+/*=============
+** INTERFACE
+=============*/
+Noise typicalNoise(double scale){
+	Noise noise;
+	noise.encoder_scale = 0.01 * scale;
+	noise.encoder_jitter = 0.05 * scale;
+	noise.imu_drift = 0.02 * scale;
+	noise.wheel_slip = std::min(0.9, 0.1 * scale);
+	noise.battery_sag = std::min(0.9, 0.15 * scale);
+	noise.sensor_jitter = 20 * scale;
+	return noise;
+}
+
+void setNoise(const Noise& noise, std::uint32_t seed){
+	noise_state = NoiseState {};
+	noise_state.noise = noise;
+	noise_state.random.seed(seed);
+
+	for(double& scale : noise_state.encoder_scale) scale = 1 + gaussian(noise.encoder_scale);
+	noise_state.imu_drift = gaussian(noise.imu_drift);
+	noise_state.slip = uniform(noise.wheel_slip);
+	noise_state.sag = uniform(noise.battery_sag);
+}
+
+void resetRobot(const Pose& start){
+	state = RobotState {};
+	state.pose = start;
+	noise_state.elapsed = 0;
+
+	auto addBall = [](bool red, double x, double y){
+		if(state.ball_count >= SIM_MAX_BALLS) return;
+		Ball& ball = state.balls[state.ball_count++];
+		ball.red = red;
+		ball.state = BALL_ON_FIELD;
+		ball.x = x;
+		ball.y = y;
+		ball.goal = -1;
+		ball.scored_at = 0;
+	};
+
+	//Preload, already at the top roller
+	addBall(true, start.x, start.y);
+	state.balls[0].state = BALL_IN_TOP;
+	state.balls[0].position = 0;
+
+	for(const auto& ball : RED_BALLS) addBall(true, ball[0], ball[1]);
+	for(const auto& ball : BLUE_BALLS) addBall(false, ball[0], ball[1]);
+
+	Devices& state_devices = devices();
+	state_devices.imus[IMU_PORT].heading = start.heading;
+	updateSensors(state_devices);
+}
+
+void stepRobot(double dt){
+	Devices& state_devices = devices();
+	noise_state.elapsed += dt;
+	for(int port = 1; port <= SIM_SMART_PORTS; port++) stepMotor(state_devices.motors[port], dt);
+
+	stepDrive(state_devices, dt);
+	stepBalls(state_devices, dt);
+	updateSensors(state_devices);
+}
+
+const RobotState& robotState(){
+	return state;
+}
+
+int ballsHeld(){
+	int held = 0;
+	for(int i = 0; i < state.ball_count; i++){
+		if(state.balls[i].state == BALL_IN_CONVEYER || state.balls[i].state == BALL_IN_TOP) held += 1;
+	}
+	return held;
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef _SIM_ROBOT_HPP_
+#define _SIM_ROBOT_HPP_
+
+#include "sim.hpp"
+
+/*=============
+** ROBOT PHYSICS
+=============*/
+/*A kinematic model of the robot, good enough to close the loop around the autonomous routine and driver
+	control: first order motors, an X-drive that goes where its wheels point (clamped to the field walls),
+	tracking wheels and inertial sensor that read the true motion, and a conveyer that carries balls past the
+	three analog sensors. Field units are tracking wheel ticks like the robot's odometry, heading is clockwise
+	degrees from +y.
+
+	Sensors and drive are perfect unless setNoise() says otherwise. Not modelled: collisions with balls and
+	goals, descoring.*/
+
+namespace sim{
+
+enum BallState{
+	BALL_ON_FIELD,
+	BALL_IN_CONVEYER,      //position is how far up the middle roller it is
+	BALL_IN_TOP,           //position is top roller travel, + towards the goal, - out the back
+	BALL_SCORED
+};
+
+struct Ball{
+	bool red;
+	BallState state;
+	double x;
+	double y;
+	double position;
+	int goal;              //Goal it was scored in
+	std::uint32_t scored_at;   //millis() when it went in
+};
+
+#define SIM_MAX_BALLS 32
+#define SIM_GOAL_COUNT 9
+
+struct Pose{
+	double x;
+	double y;
+	double heading;
+};
+
+struct RobotState{
+	Pose pose;
+	double forward_speed;  //Ticks/s in the robot frame
+	double strafe_speed;
+	double turn_rate;      //Degrees/s
+
+	Ball balls[SIM_MAX_BALLS];
+	int ball_count;
+
+	int scored;            //Balls of ours that went into a goal
+	int scored_theirs;
+	int ejected;           //Balls that left out the back
+};
+
+//Imperfections of a real robot, all off by default. Each run draws its own biases from its seed
+struct Noise{
+	double encoder_scale = 0;   //Standard deviation of each tracking wheel's scale error (0.01 is 1%)
+	double encoder_jitter = 0;  //Standard deviation of the tick error per tick travelled
+	double imu_drift = 0;       //Standard deviation of the inertial sensor's drift, degrees/s
+	double wheel_slip = 0;      //Most of the drive's motion that can be lost to slip (0.1 is 10%)
+	double battery_sag = 0;     //Most of the motor voltage the battery can lose over a minute
+	double sensor_jitter = 0;   //Standard deviation of the analog sensor readings
+};
+
+//What a match throws at the robot, times scale (2 for a bad day)
+Noise typicalNoise(double scale);
+
+//Call before resetRobot(), with deviceMutex() held
+void setNoise(const Noise& noise, std::uint32_t seed);
+
+//Puts the robot at a pose with the preload in the top roller and the field balls out
+void resetRobot(const Pose& start);
+
+//Advances the physics by dt seconds. Call with deviceMutex() held
+void stepRobot(double dt);
+
+//Also only valid with deviceMutex() held
+const RobotState& robotState();
+
+//Balls currently in the robot
+int ballsHeld();
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef _SIM_HPP_
+#define _SIM_HPP_
+
+#include "api.h"
+#include <cstdint>
+#include <mutex>
+
+/*=============
+** HOST SIMULATOR
+=============*/
+/*The simulator builds every file in src/ unchanged for Linux (make sim) and links it against the PROS API
+	implemented in sim/pros_sim.cpp instead of libpros. Every device call reads or writes the state below,
+	and sim/robot.cpp moves the robot, the tracking wheels and the balls from the motor commands.
+
+	Host builds define HOST_BUILD, so the robot code writes its files to the working directory.*/
+
+namespace sim{
+
+/*=============
+** TIME AND TASKS (sim_time.cpp)
+=============*/
+//Virtual ms/us since the program started, see sim_time.cpp
+std::uint32_t millis();
+std::uint64_t micros();
+
+//0 (the default) runs as fast as possible, otherwise virtual time is held to this many times the wall clock
+void setSpeed(double speed);
+
+void delay(std::uint32_t milliseconds);
+void delayUntil(std::uint32_t* previous, std::uint32_t delta);
+
+typedef void (*TaskFunction)(void*);
+
+void* createTask(TaskFunction function, void* parameter, std::uint32_t priority, const char* name);
+void* currentTask();
+std::uint32_t taskCount();
+void setPriority(void* task, std::uint32_t priority);
+
+void notify(void* task);
+std::uint32_t notifyTake(bool clear_on_exit, std::uint32_t timeout);
+
+void* createMutex();
+bool takeMutex(void* mutex, std::uint32_t timeout);
+bool giveMutex(void* mutex);
+
+/*=============
+** DEVICES (pros_sim.cpp)
+=============*/
+#define SIM_SMART_PORTS 22
+#define SIM_ADI_PORTS 8
+//Smart port number PROS uses for the brain's own ADI ports
+#define SIM_BRAIN_ADI 22
+
+struct MotorDevice{
+	std::int32_t voltage;          //Commanded mV (after reversing)
+	bool position_mode;            //move_absolute()/move_relative() in progress
+	double target_position;        //Degrees, motor frame
+	std::int32_t target_velocity;  //RPM limit for position moves
+	pros::motor_brake_mode_e_t brake_mode;
+	pros::motor_gearset_e_t gearset;
+	bool reversed;
+
+	double velocity;               //RPM
+	double position;               //Degrees
+	double zero;                   //Position tare_position() was called at
+	double current;                //mA
+	double torque;                 //Nm
+	double temperature;            //C
+};
+
+struct AdiDevice{
+	std::int32_t value;            //Analog reading (0-4095)
+	double ticks;                  //Encoder count, kept on the top port
+	std::int32_t calibration;
+	std::int32_t encoder_offset;   //Count at the last reset()
+	bool reversed;
+};
+
+struct ImuDevice{
+	double heading;                //True heading from the physics, clockwise degrees
+	double rate;                   //True turn rate, clockwise degrees per second
+	double offset;                 //Subtracted by tare
+	std::uint32_t calibrated_at;   //millis() when a reset finishes
+};
+
+struct VisionBlob{
+	std::uint8_t signature;
+	std::int16_t x;                //Centre, px
+	std::int16_t y;
+	std::int16_t width;
+	std::int16_t height;
+};
+
+#define SIM_MAX_BLOBS 8
+
+struct ControllerDevice{
+	std::int32_t analog[4];        //Indexed by pros::controller_analog_e_t
+	bool digital[12];              //Indexed by button - E_CONTROLLER_DIGITAL_L1
+	bool reported[12];             //Press already returned by get_digital_new_press()
+	char text[3][16];
+	char rumble[9];
+};
+
+struct Devices{
+	MotorDevice motors[SIM_SMART_PORTS + 1];
+	AdiDevice adi[SIM_SMART_PORTS + 1][SIM_ADI_PORTS + 1];
+	ImuDevice imus[SIM_SMART_PORTS + 1];
+	VisionBlob blobs[SIM_MAX_BLOBS];
+	int blob_count;
+	ControllerDevice controller;
+	char lcd[8][48];
+
+	bool autonomous;
+	bool disabled;
+	bool sd_card;
+};
+
+//Everything above, guarded by deviceMutex()
+Devices& devices();
+std::mutex& deviceMutex();
+
+//Free speed of a motor cartridge, RPM
+double maxRpm(pros::motor_gearset_e_t gearset);
+
+}
+
+#endif
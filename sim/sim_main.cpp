@@ -0,0 +1,287 @@
+/*Runs the robot code against the simulated robot (make sim).
+
+	sim [--mode auton|driver] [--duration s] [--speed x] [--start x,y,heading] [--out traj.csv] [--sample ms]
+	    [--serial file] [--driver script.csv] [--no-sd] [--seed n] [--noise scale] [--set NAME=value]...
+
+	initialize() runs first like on the brain, then autonomous() or opcontrol() until it returns or --duration
+	seconds (default 60) have passed. Time is virtual, so by default a run takes as long as the code takes to
+	execute and repeats exactly; --speed paces it at that many times real time instead (1 to watch it live).
+
+	--out writes the true and odometry pose and the drive commands every --sample ms (default 10, a multiple
+	of 10). Everything the robot prints over serial, telemetry included, goes to --serial (default
+	sim_serial.bin, read it with telemetry_decode); the files it writes to the SD card end up in the working
+	directory unless --no-sd.
+
+	A driver script is a CSV of time_ms,left_x,left_y,right_x,right_y,buttons rows, times relative to the
+	start of opcontrol(). Each row holds until the next one; buttons is a bit mask with bit 0 = L1 in
+	pros::controller_digital_e_t order (L1 L2 R1 R2 UP DOWN LEFT RIGHT X B Y A).
+
+	--seed turns on encoder, inertial sensor, wheel slip, battery and ball sensor noise (see sim::Noise), its
+	biases drawn from the seed so a run can be repeated exactly. --noise scales it (default 1).
+
+	--set overrides one of the drive() constants in include/drive_tuning.hpp for this run, by its name there
+	(--set KPBASE=0.15). tools/optimize.cpp uses it to try candidate values.*/
+
+#include "main.h"
+#include "ports.hpp"
+#include "robot.hpp"
+#include "sensors.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+//From src/main.cpp
+SensorSnapshot latestSensors();
+extern double kp_base;
+extern double kp_base_turn;
+extern float close_turn;
+extern float close_move;
+
+#define SIM_SAMPLE_MS 10
+
+struct DriverRow{
+	std::uint32_t time;
+	std::int32_t analog[4];
+	std::uint32_t buttons;
+};
+
+struct Options{
+	bool autonomous = true;
+	double duration = 60;
+	double speed = 0;
+	sim::Pose start = {0, 0, 0};
+	const char* trajectory_path = nullptr;
+	std::uint32_t sample_ms = SIM_SAMPLE_MS;
+	const char* serial_path = "sim_serial.bin";
+	const char* driver_path = nullptr;
+	bool sd_card = true;
+	bool noisy = false;
+	std::uint32_t seed = 0;
+	double noise = 1;
+};
+
+static std::atomic<bool> mode_started {false};
+static std::atomic<bool> mode_finished {false};
+
+static void usage(const char* name){
+	fprintf(stderr, "usage: %s [--mode auton|driver] [--duration s] [--speed x] [--start x,y,heading] [--out traj.csv] [--sample ms]\n"
+		"       [--serial file] [--driver script.csv] [--no-sd] [--seed n] [--noise scale] [--set NAME=value]...\n", name);
+	std::exit(1);
+}
+
+//--set NAME=value, false if there's no constant by that name
+static bool setTuning(const char* assignment){
+	char name[32];
+	double value;
+	if(std::sscanf(assignment, "%31[^=]=%lf", name, &value) != 2) return false;
+
+	if(std::strcmp(name, "KPBASE") == 0) kp_base = value;
+	else if(std::strcmp(name, "KPBASETURN") == 0) kp_base_turn = value;
+	else if(std::strcmp(name, "CLOSE_TURN") == 0) close_turn = value;
+	else if(std::strcmp(name, "CLOSE_MOVE") == 0) close_move = value;
+	else return false;
+	return true;
+}
+
+static Options parseOptions(int argc, char** argv){
+	Options options;
+	for(int i = 1; i < argc; i++){
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if(std::strcmp(arg, "--no-sd") == 0){
+			options.sd_card = false;
+			continue;
+		}
+		if(value == nullptr) usage(argv[0]);
+		i += 1;
+
+		if(std::strcmp(arg, "--mode") == 0){
+			if(std::strcmp(value, "auton") == 0) options.autonomous = true;
+			else if(std::strcmp(value, "driver") == 0) options.autonomous = false;
+			else usage(argv[0]);
+		}
+		else if(std::strcmp(arg, "--duration") == 0) options.duration = std::atof(value);
+		else if(std::strcmp(arg, "--speed") == 0) options.speed = std::atof(value);
+		else if(std::strcmp(arg, "--start") == 0){
+			if(std::sscanf(value, "%lf,%lf,%lf", &options.start.x, &options.start.y, &options.start.heading) != 3) usage(argv[0]);
+		}
+		else if(std::strcmp(arg, "--out") == 0) options.trajectory_path = value;
+		else if(std::strcmp(arg, "--sample") == 0) options.sample_ms = std::strtoul(value, nullptr, 10);
+		else if(std::strcmp(arg, "--serial") == 0) options.serial_path = value;
+		else if(std::strcmp(arg, "--driver") == 0) options.driver_path = value;
+		else if(std::strcmp(arg, "--seed") == 0){
+			options.noisy = true;
+			options.seed = std::strtoul(value, nullptr, 10);
+		}
+		else if(std::strcmp(arg, "--noise") == 0) options.noise = std::atof(value);
+		else if(std::strcmp(arg, "--set") == 0){
+			if(setTuning(value) == false) usage(argv[0]);
+		}
+		else usage(argv[0]);
+	}
+	if(options.duration <= 0 || options.speed < 0 || options.noise < 0) usage(argv[0]);
+	if(options.sample_ms == 0 || options.sample_ms % SIM_SAMPLE_MS != 0) usage(argv[0]);
+	return options;
+}
+
+static bool readDriverScript(const char* path, std::vector<DriverRow>& rows){
+	std::FILE* file = std::fopen(path, "r");
+	if(file == nullptr){
+		perror(path);
+		return false;
+	}
+
+	char line[256];
+	while(std::fgets(line, sizeof(line), file)){
+		//Header and comments don't parse
+		DriverRow row;
+		if(std::sscanf(line, "%u,%d,%d,%d,%d,%u", &row.time, &row.analog[0], &row.analog[1], &row.analog[2], &row.analog[3], &row.buttons) == 6){
+			rows.push_back(row);
+		}
+	}
+
+	std::fclose(file);
+	return true;
+}
+
+//The brain's main task: initialize(), then the competition mode
+static void robotTask(void* parameter){
+	const Options& options = *static_cast<const Options*>(parameter);
+
+	initialize();
+
+	if(options.autonomous){
+		{
+			std::lock_guard<std::mutex> lock (sim::deviceMutex());
+			sim::devices().autonomous = true;
+		}
+		mode_started = true;
+		autonomous();
+	}
+	else{
+		mode_started = true;
+		opcontrol();
+	}
+	mode_finished = true;
+}
+
+//Steps the physics every ms, at the highest priority so every task sees the state for the current ms
+static void physicsTask(void*){
+	while(true){
+		{
+			std::lock_guard<std::mutex> lock (sim::deviceMutex());
+			sim::stepRobot(0.001);
+		}
+		sim::delay(1);
+	}
+}
+
+static void writeSample(std::FILE* file){
+	SensorSnapshot odometry = latestSensors();
+
+	std::lock_guard<std::mutex> lock (sim::deviceMutex());
+	const sim::RobotState& state = sim::robotState();
+	const sim::MotorDevice* motors = sim::devices().motors;
+	fprintf(file, "%u,%.1f,%.1f,%.2f,%.1f,%.1f,%.2f,%d,%d,%d,%d,%d,%d,%d,%d\n", sim::millis(),
+		state.pose.x, state.pose.y, state.pose.heading, odometry.pos_x, odometry.pos_y, odometry.heading,
+		motors[LEFT_WHEEL_FRONT_PORT].voltage, motors[LEFT_WHEEL_BACK_PORT].voltage,
+		motors[RIGHT_WHEEL_FRONT_PORT].voltage, motors[RIGHT_WHEEL_BACK_PORT].voltage,
+		motors[FEEDER_TOP_PORT].voltage, motors[FEEDER_MIDDLE_PORT].voltage,
+		sim::ballsHeld(), state.scored);
+}
+
+static void applyDriverRow(const DriverRow& row){
+	std::lock_guard<std::mutex> lock (sim::deviceMutex());
+	sim::ControllerDevice& controller = sim::devices().controller;
+	for(int i = 0; i < 4; i++) controller.analog[i] = row.analog[i];
+	for(int i = 0; i < 12; i++) controller.digital[i] = (row.buttons >> i) & 1;
+}
+
+static void printSummary(const Options& options, std::uint32_t mode_start){
+	SensorSnapshot odometry = latestSensors();
+
+	std::lock_guard<std::mutex> lock (sim::deviceMutex());
+	const sim::RobotState& state = sim::robotState();
+	fprintf(stderr, "[sim] %s %s after %u ms\n", options.autonomous ? "autonomous" : "driver control",
+		mode_finished ? "finished" : "stopped", sim::millis() - mode_start);
+	fprintf(stderr, "[sim] scored %d (%d of theirs), ejected %d, holding %d\n", state.scored, state.scored_theirs, state.ejected, sim::ballsHeld());
+	//When each of ours went in, so tools can tell which scoring segment it belongs to
+	for(int i = 0; i < state.ball_count; i++){
+		const sim::Ball& ball = state.balls[i];
+		if(ball.state == sim::BALL_SCORED && ball.red) fprintf(stderr, "[sim] goal %d at %u ms\n", ball.goal, ball.scored_at - mode_start);
+	}
+	fprintf(stderr, "[sim] pose %.0f %.0f %.1f, odometry %.0f %.0f %.1f\n", state.pose.x, state.pose.y, state.pose.heading,
+		odometry.pos_x, odometry.pos_y, odometry.heading);
+}
+
+int main(int argc, char** argv){
+	Options options = parseOptions(argc, argv);
+
+	std::vector<DriverRow> driver_rows;
+	if(options.driver_path != nullptr && readDriverScript(options.driver_path, driver_rows) == false) return 1;
+
+	std::FILE* trajectory = nullptr;
+	if(options.trajectory_path != nullptr){
+		trajectory = std::fopen(options.trajectory_path, "w");
+		if(trajectory == nullptr){
+			perror(options.trajectory_path);
+			return 1;
+		}
+		fprintf(trajectory, "time,x,y,heading,odom_x,odom_y,odom_heading,left_front_mv,left_back_mv,right_front_mv,right_back_mv,"
+			"feeder_top_mv,feeder_middle_mv,balls_held,scored\n");
+	}
+
+	//The robot's serial output, telemetry frames and all
+	if(std::freopen(options.serial_path, "wb", stdout) == nullptr){
+		perror(options.serial_path);
+		return 1;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (sim::deviceMutex());
+		sim::devices().sd_card = options.sd_card;
+		if(options.noisy) sim::setNoise(sim::typicalNoise(options.noise), options.seed);
+		sim::resetRobot(options.start);
+	}
+	sim::setSpeed(options.speed);
+
+	//This thread samples the run, after every robot task has had its go at each tick
+	sim::setPriority(sim::currentTask(), TASK_PRIORITY_MIN);
+	sim::createTask(physicsTask, nullptr, TASK_PRIORITY_MAX, "physics");
+	sim::createTask(robotTask, &options, TASK_PRIORITY_DEFAULT, "main");
+
+	while(mode_started == false) sim::delay(1);
+	std::uint32_t mode_start = sim::millis();
+	std::uint32_t end = mode_start + options.duration * 1000;
+
+	std::size_t next_row = 0;
+	std::uint32_t now = mode_start;
+	while(mode_finished == false && (std::int32_t)(end - now) > 0){
+		while(next_row < driver_rows.size() && driver_rows[next_row].time <= now - mode_start){
+			applyDriverRow(driver_rows[next_row]);
+			next_row += 1;
+		}
+		if(trajectory != nullptr && (now - mode_start) % options.sample_ms == 0) writeSample(trajectory);
+
+		sim::delayUntil(&now, SIM_SAMPLE_MS);
+	}
+
+	//The field disables the robot at the end of the period
+	{
+		std::lock_guard<std::mutex> lock (sim::deviceMutex());
+		sim::devices().autonomous = false;
+		sim::devices().disabled = true;
+	}
+	disabled();
+
+	printSummary(options, mode_start);
+	if(trajectory != nullptr) std::fclose(trajectory);
+
+	//Robot tasks never return, so don't wait for them
+	std::fflush(nullptr);
+	_exit(0);
+}
@@ -0,0 +1,322 @@
+#include "sim.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/*Simulated time is virtual: it only moves when every task is blocked, and then jumps straight to the next
+	wake up, so a 5 ms delay costs no wall time at all. Every PROS task is still a thread, but exactly one of
+	them runs at a time and the others wait for the scheduler to hand over. Like FreeRTOS, the highest priority
+	ready task runs, tasks of equal priority take turns in the order they became ready, and a task that readies
+	a higher priority one (notify, mutex give, create) hands over straight away. Nothing depends on the host's
+	thread timing, so the same inputs give the same run bit for bit.
+
+	The only preemption points are PROS calls: a task that loops without ever delaying or waiting stalls the
+	simulation, just like it would starve lower priority tasks on the brain.*/
+
+namespace sim{
+
+namespace{
+
+typedef std::chrono::steady_clock Clock;
+typedef std::unique_lock<std::mutex> Lock;
+
+#define NO_WAKE UINT64_MAX
+
+enum TaskState{
+	TASK_READY,
+	TASK_RUNNING,
+	TASK_BLOCKED,
+	TASK_DONE
+};
+
+struct Mutex;
+
+struct Task{
+	std::string name;
+	std::uint32_t priority;
+	TaskState state = TASK_READY;
+	std::uint64_t order = 0;            //When it last became ready or blocked, breaks ties between equals
+	std::uint64_t wake_us = NO_WAKE;    //Timeout while blocked
+	std::uint32_t notify_value = 0;
+	bool waiting_notify = false;
+	Mutex* waiting_mutex = nullptr;
+	std::condition_variable turn;
+};
+
+struct Mutex{
+	Task* owner = nullptr;
+};
+
+std::mutex scheduler_mutex;
+std::vector<Task*> tasks;
+Task* running = nullptr;
+std::uint64_t order_counter = 0;
+std::atomic<std::uint64_t> now_us {0};
+
+//0 runs as fast as possible, anything else paces virtual time against the wall clock
+double speed = 0;
+Clock::time_point real_start = Clock::now();
+
+thread_local Task* current_task = nullptr;
+
+Task* newTask(const char* name, std::uint32_t priority){
+	Task* task = new Task();
+	task->name = name != nullptr ? name : "";
+	task->priority = priority;
+	tasks.push_back(task);
+	return task;
+}
+
+//The calling thread's task. The thread that first calls in (main()) becomes a task itself
+Task* self(){
+	if(current_task == nullptr){
+		if(running != nullptr){
+			fprintf(stderr, "[sim] a thread outside the scheduler called into PROS\n");
+			std::fflush(nullptr);
+			_exit(1);
+		}
+		current_task = newTask("main", TASK_PRIORITY_DEFAULT);
+		current_task->state = TASK_RUNNING;
+		running = current_task;
+	}
+	return current_task;
+}
+
+void makeReady(Task* task){
+	task->state = TASK_READY;
+	task->wake_us = NO_WAKE;
+	task->order = ++order_counter;
+}
+
+void block(Task* task, std::uint32_t timeout_ms){
+	task->state = TASK_BLOCKED;
+	task->wake_us = timeout_ms == TIMEOUT_MAX ? NO_WAKE : now_us + (std::uint64_t)timeout_ms * 1000;
+	task->order = ++order_counter;
+}
+
+//Highest priority, then longest ready
+Task* nextReady(){
+	Task* next = nullptr;
+	for(Task* task : tasks){
+		if(task->state != TASK_READY) continue;
+		if(next == nullptr || task->priority > next->priority || (task->priority == next->priority && task->order < next->order)) next = task;
+	}
+	return next;
+}
+
+//Jumps to the earliest timeout and readies every task waiting for it, in the order they blocked
+void advanceTime(Lock& lock){
+	std::uint64_t wake = NO_WAKE;
+	for(Task* task : tasks){
+		if(task->state == TASK_BLOCKED) wake = std::min(wake, task->wake_us);
+	}
+	if(wake == NO_WAKE){
+		fprintf(stderr, "[sim] every task is blocked with no timeout\n");
+		std::fflush(nullptr);
+		_exit(1);
+	}
+
+	if(speed > 0){
+		Clock::time_point real_wake = real_start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(wake / speed));
+		lock.unlock();
+		std::this_thread::sleep_until(real_wake);
+		lock.lock();
+	}
+	now_us = wake;
+
+	std::vector<Task*> woken;
+	for(Task* task : tasks){
+		if(task->state == TASK_BLOCKED && task->wake_us == wake) woken.push_back(task);
+	}
+	std::sort(woken.begin(), woken.end(), [](const Task* a, const Task* b){ return a->order < b->order; });
+	for(Task* task : woken){
+		task->waiting_notify = false;
+		task->waiting_mutex = nullptr;
+		makeReady(task);
+	}
+}
+
+void waitTurn(Lock& lock, Task* task){
+	task->turn.wait(lock, [task]{ return running == task; });
+	task->state = TASK_RUNNING;
+}
+
+//Hands over to the next ready task (advancing time if there is none) and returns on this task's next turn
+void reschedule(Lock& lock, Task* task){
+	Task* next = nextReady();
+	while(next == nullptr){
+		advanceTime(lock);
+		next = nextReady();
+	}
+
+	running = next;
+	if(next == task){
+		task->state = TASK_RUNNING;
+		return;
+	}
+	next->turn.notify_one();
+	if(task->state != TASK_DONE) waitTurn(lock, task);
+}
+
+//After readying a task: a higher priority one runs right away, like a context switch on the brain
+void preempt(Lock& lock, Task* task){
+	Task* next = nextReady();
+	if(next != nullptr && next->priority > task->priority){
+		makeReady(task);
+		reschedule(lock, task);
+	}
+}
+
+}
+
+std::uint64_t micros(){
+	return now_us;
+}
+
+std::uint32_t millis(){
+	return now_us / 1000;
+}
+
+void setSpeed(double new_speed){
+	Lock lock (scheduler_mutex);
+	speed = new_speed;
+	if(speed > 0) real_start = Clock::now() - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(now_us / speed));
+}
+
+void delay(std::uint32_t milliseconds){
+	Lock lock (scheduler_mutex);
+	Task* task = self();
+
+	//delay(0) just lets tasks of the same priority have a go
+	if(milliseconds == 0) makeReady(task);
+	else block(task, milliseconds);
+	reschedule(lock, task);
+}
+
+void delayUntil(std::uint32_t* previous, std::uint32_t delta){
+	std::uint32_t wake = *previous + delta;
+	*previous = wake;
+
+	//Already late, carry on without blocking
+	std::uint32_t now = millis();
+	if((std::int32_t)(wake - now) > 0) delay(wake - now);
+}
+
+void* createTask(TaskFunction function, void* parameter, std::uint32_t priority, const char* name){
+	Lock lock (scheduler_mutex);
+	Task* creator = self();
+	Task* task = newTask(name, priority);
+	makeReady(task);
+
+	std::thread([task, function, parameter]{
+		Lock lock (scheduler_mutex);
+		current_task = task;
+		waitTurn(lock, task);
+		lock.unlock();
+
+		function(parameter);
+
+		lock.lock();
+		task->state = TASK_DONE;
+		reschedule(lock, task);
+	}).detach();
+
+	preempt(lock, creator);
+	return task;
+}
+
+void* currentTask(){
+	Lock lock (scheduler_mutex);
+	return self();
+}
+
+std::uint32_t taskCount(){
+	Lock lock (scheduler_mutex);
+	return std::count_if(tasks.begin(), tasks.end(), [](const Task* task){ return task->state != TASK_DONE; });
+}
+
+void setPriority(void* handle, std::uint32_t priority){
+	Lock lock (scheduler_mutex);
+	Task* task = self();
+	static_cast<Task*>(handle)->priority = priority;
+	preempt(lock, task);
+}
+
+void notify(void* handle){
+	Lock lock (scheduler_mutex);
+	Task* task = self();
+	Task* target = static_cast<Task*>(handle);
+
+	target->notify_value += 1;
+	if(target->state == TASK_BLOCKED && target->waiting_notify){
+		target->waiting_notify = false;
+		makeReady(target);
+	}
+	preempt(lock, task);
+}
+
+std::uint32_t notifyTake(bool clear_on_exit, std::uint32_t timeout){
+	Lock lock (scheduler_mutex);
+	Task* task = self();
+
+	if(task->notify_value == 0 && timeout != 0){
+		block(task, timeout);
+		task->waiting_notify = true;
+		reschedule(lock, task);
+	}
+
+	std::uint32_t value = task->notify_value;
+	if(value > 0) task->notify_value = clear_on_exit ? 0 : value - 1;
+	return value;
+}
+
+void* createMutex(){
+	return new Mutex();
+}
+
+bool takeMutex(void* handle, std::uint32_t timeout){
+	Lock lock (scheduler_mutex);
+	Task* task = self();
+	Mutex* mutex = static_cast<Mutex*>(handle);
+
+	if(mutex->owner == nullptr){
+		mutex->owner = task;
+		return true;
+	}
+	if(timeout == 0) return false;
+
+	//giveMutex() hands the mutex straight to the waiter it readies
+	block(task, timeout);
+	task->waiting_mutex = mutex;
+	reschedule(lock, task);
+	return mutex->owner == task;
+}
+
+bool giveMutex(void* handle){
+	Lock lock (scheduler_mutex);
+	Task* task = self();
+	Mutex* mutex = static_cast<Mutex*>(handle);
+
+	mutex->owner = nullptr;
+
+	Task* waiter = nullptr;
+	for(Task* other : tasks){
+		if(other->state != TASK_BLOCKED || other->waiting_mutex != mutex) continue;
+		if(waiter == nullptr || other->priority > waiter->priority || (other->priority == waiter->priority && other->order < waiter->order)) waiter = other;
+	}
+	if(waiter != nullptr){
+		mutex->owner = waiter;
+		waiter->waiting_mutex = nullptr;
+		makeReady(waiter);
+		preempt(lock, task);
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,117 @@
+#include "ball_sort.hpp"
+#include <cstdlib>
+
+BallSorter::BallSorter(){
+	clear();
+}
+
+void BallSorter::update(const pros::vision_object_s_t* ours, int our_count, const pros::vision_object_s_t* theirs, int their_count){
+	bool matched[BALL_MAX_TRACKS] = {};
+
+	for(int i = 0; i < our_count; i++) match(ours[i], true, matched);
+	for(int i = 0; i < their_count; i++) match(theirs[i], false, matched);
+
+	for(int i = 0; i < BALL_MAX_TRACKS; i++){
+		BallTrack& track = tracks_[i];
+		if(track.active == false) continue;
+
+		if(matched[i] == false){
+			track.misses += 1;
+			if(track.misses > BALL_TRACK_MAX_MISSES) track.active = false;
+			continue;
+		}
+
+		//Ball is entering the intake, its color is decided by what most frames saw
+		if(track.decided == false && track.hits >= BALL_TRACK_MIN_HITS && track.bottom > BALL_INTAKE_LINE){
+			track.decided = true;
+			push(track.their_votes > track.our_votes ? BALL_EJECT : BALL_STORE);
+		}
+	}
+}
+
+void BallSorter::match(const pros::vision_object_s_t& object, bool ours, bool* matched){
+	if(object.signature == VISION_OBJECT_ERR_SIG) return;
+	if(object.width * object.height < BALL_MIN_AREA) return;
+
+	//Nearest track that hasn't been used this frame
+	int best = -1;
+	int best_distance = BALL_TRACK_GATE + 1;
+	for(int i = 0; i < BALL_MAX_TRACKS; i++){
+		if(tracks_[i].active == false || matched[i] == true) continue;
+		int distance = abs(tracks_[i].x - object.x_middle_coord) + abs(tracks_[i].y - object.y_middle_coord);
+		if(distance < best_distance){
+			best = i;
+			best_distance = distance;
+		}
+	}
+
+	//New ball, takes the first free slot (dropped if the sensor sees more balls than we can track)
+	if(best == -1){
+		for(int i = 0; i < BALL_MAX_TRACKS; i++){
+			if(tracks_[i].active == false){
+				tracks_[i] = BallTrack{true, 0, 0, 0, 0, 0, 0, 0, false};
+				best = i;
+				break;
+			}
+		}
+		if(best == -1) return;
+	}
+
+	BallTrack& track = tracks_[best];
+	track.x = object.x_middle_coord;
+	track.y = object.y_middle_coord;
+	track.bottom = object.top_coord + object.height;
+	track.hits += 1;
+	track.misses = 0;
+	if(ours) track.our_votes += 1;
+	else track.their_votes += 1;
+	matched[best] = true;
+}
+
+void BallSorter::push(BallDecision decision){
+	//Oldest decision is dropped if the conveyer never took it
+	if(size_ == BALL_MAX_DECISIONS){
+		head_ = (head_ + 1) % BALL_MAX_DECISIONS;
+		size_ -= 1;
+	}
+
+	decisions_[(head_ + size_) % BALL_MAX_DECISIONS] = decision;
+	size_ += 1;
+}
+
+BallDecision BallSorter::front() const{
+	if(size_ == 0) return BALL_NONE;
+	return decisions_[head_];
+}
+
+BallDecision BallSorter::pop(){
+	if(size_ == 0) return BALL_NONE;
+
+	BallDecision decision = decisions_[head_];
+	head_ = (head_ + 1) % BALL_MAX_DECISIONS;
+	size_ -= 1;
+
+	if(decision == BALL_STORE) stored_ += 1;
+	else if(decision == BALL_EJECT) ejected_ += 1;
+	return decision;
+}
+
+int BallSorter::pending() const{
+	return size_;
+}
+
+void BallSorter::clear(){
+	for(int i = 0; i < BALL_MAX_TRACKS; i++) tracks_[i].active = false;
+	head_ = 0;
+	size_ = 0;
+	stored_ = 0;
+	ejected_ = 0;
+}
+
+int BallSorter::storedCount() const{
+	return stored_;
+}
+
+int BallSorter::ejectedCount() const{
+	return ejected_;
+}
@@ -0,0 +1,94 @@
+#include "calibration.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+struct CalibrationHeader{
+	std::uint32_t magic;
+	std::uint16_t version;
+	std::uint16_t size;
+};
+
+//CRC-32 (the zip one, reflected 0xEDB88320), over the header and data
+static std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc = 0){
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+	crc = ~crc;
+	for(std::size_t i = 0; i < size; i++){
+		crc ^= bytes[i];
+		for(int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+	}
+	return ~crc;
+}
+
+bool loadCalibration(const char* path, CalibrationData& data){
+	std::FILE* file = std::fopen(path, "rb");
+	if(file == nullptr) return false;
+
+	CalibrationHeader header;
+	CalibrationData stored;
+	std::uint32_t crc;
+	bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+		header.magic == CALIBRATION_MAGIC && header.version == CALIBRATION_VERSION && header.size == sizeof(CalibrationData) &&
+		std::fread(&stored, sizeof(stored), 1, file) == 1 &&
+		std::fread(&crc, sizeof(crc), 1, file) == 1 &&
+		crc == crc32(&stored, sizeof(stored), crc32(&header, sizeof(header)));
+	std::fclose(file);
+
+	if(ok) data = stored;
+	return ok;
+}
+
+bool saveCalibration(const char* path, const CalibrationData& data){
+	std::FILE* file = std::fopen(path, "wb");
+	if(file == nullptr) return false;
+
+	CalibrationHeader header = {CALIBRATION_MAGIC, CALIBRATION_VERSION, sizeof(CalibrationData)};
+	std::uint32_t crc = crc32(&data, sizeof(data), crc32(&header, sizeof(header)));
+	bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+		std::fwrite(&data, sizeof(data), 1, file) == 1 &&
+		std::fwrite(&crc, sizeof(crc), 1, file) == 1;
+	return std::fclose(file) == 0 && ok;
+}
+
+void CalibrationRefresh::reset(){
+	started_ = false;
+}
+
+bool CalibrationRefresh::sample(const SensorSnapshot& sensors, double gyro_rate, CalibrationData& data){
+	//A tracking wheel turning means the robot is being moved, the window starts over
+	if(started_ && (std::abs(sensors.left_encoder - previous_.left_encoder) > CALIBRATION_STILL_TICKS ||
+		std::abs(sensors.right_encoder - previous_.right_encoder) > CALIBRATION_STILL_TICKS ||
+		std::abs(sensors.center_encoder - previous_.center_encoder) > CALIBRATION_STILL_TICKS)){
+		started_ = false;
+	}
+
+	if(started_ == false){
+		started_ = true;
+		first_ = sensors;
+		previous_ = sensors;
+		heading_change_ = 0;
+		gyro_total_ = 0;
+		samples_ = 0;
+		return false;
+	}
+
+	//Heading wraps at 360
+	double change = sensors.heading - previous_.heading;
+	if(change > 180) change -= 360;
+	if(change < -180) change += 360;
+	heading_change_ += change;
+
+	gyro_total_ += gyro_rate;
+	samples_ += 1;
+	previous_ = sensors;
+
+	std::uint32_t elapsed = sensors.time - first_.time;
+	if(elapsed < CALIBRATION_STILL_MS) return false;
+
+	data.gyro_bias = gyro_total_ / samples_;
+	//The heading was already corrected with the old drift, whatever it still moved is left over
+	data.heading_drift += heading_change_ / (elapsed / 1000.0);
+	data.refreshes += 1;
+
+	started_ = false;
+	return true;
+}
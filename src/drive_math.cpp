@@ -0,0 +1,121 @@
+#include "drive_math.hpp"
+#include "math.h"
+#include <cmath>
+#include <cstdlib>
+
+/*=============
+** ODOMETRY
+=============*/
+void odometryUpdate(Odometry& odometry, std::int32_t left_encoder, std::int32_t right_encoder, std::int32_t center_encoder, float heading){
+	float curr_encoder_fwd_rev = (right_encoder + left_encoder) / 2;
+	float curr_encoder_left_right = center_encoder;
+
+	float& angle_ = odometry.angle;
+	angle_ = heading;
+	if(angle_ > 360) angle_ = 0;
+	if(angle_ < 0) angle_ = angle_+360;
+	odometry.pos_x = odometry.pos_x - (((curr_encoder_fwd_rev-odometry.prev_fwd_rev) * -sin(angle_*PI/180)) + ((curr_encoder_left_right-odometry.prev_left_right) * -cos(angle_*PI/180)));
+	odometry.pos_y = odometry.pos_y + (((curr_encoder_fwd_rev-odometry.prev_fwd_rev) * cos(angle_*PI/180)) - ((curr_encoder_left_right-odometry.prev_left_right) * sin(angle_*PI/180)));
+	odometry.prev_fwd_rev = curr_encoder_fwd_rev;
+	odometry.prev_left_right = curr_encoder_left_right;
+}
+
+/*=============
+** DRIVE ANGLES
+=============*/
+int referenceAngle(float goal_x, float goal_y, float pos_x, float pos_y){
+	int reference_angle = atan((goal_x-pos_x)/(goal_y-pos_y)) * 180 / PI;
+	if((goal_y-pos_y) < 0) reference_angle = 180 + reference_angle;
+	if(reference_angle < 0) reference_angle = 360 + reference_angle;
+	return reference_angle;
+}
+
+float driveDirection(float heading, int reference_angle){
+	float difference = heading - reference_angle;
+	if(difference < 0) difference = 360 + difference;
+	difference = 360 - difference;
+	return difference;
+}
+
+float turnDifference(float heading, float goal_heading){
+	float turn_difference = heading-goal_heading;
+	if(turn_difference > 180) turn_difference = 360-turn_difference;
+	if(turn_difference < -180) turn_difference = 360+turn_difference;
+	if(turn_difference < 0 && turn_difference > -180) turn_difference = -turn_difference;
+	return turn_difference;
+}
+
+/*=============
+** DRIVER CONTROL
+=============*/
+StickCurve::StickCurve(int deadband, float expo){
+	for(int value = -STICK_MAX; value <= STICK_MAX; value++){
+		int size = std::abs(value);
+		float magnitude = size <= deadband ? 0 : (size - deadband) * (float)STICK_MAX / (STICK_MAX - deadband);
+		float fraction = magnitude / STICK_MAX;
+
+		//Written as a scale on the magnitude so expo 0 leaves it exact
+		magnitude *= (1 - expo) + expo * fraction * fraction;
+		shaped_[value + STICK_MAX] = value < 0 ? -magnitude : magnitude;
+	}
+}
+
+WheelCommands fieldCentricDrive(const StickCurve& curve, std::int32_t up_down, std::int32_t left_right, float turn, float heading){
+	WheelCommands commands = {0, 0, 0, 0};
+	if(std::isfinite(heading) == false) return commands;
+
+	float x = curve(left_right);
+	float y = curve(up_down);
+
+	//Heading as a unit vector, clockwise from +y like the sticks
+	float radians = heading * (float)(PI / 180);
+	float sin_h = std::sin(radians);
+	float cos_h = std::cos(radians);
+
+	//Left stick in the robot's frame, limited to full speed
+	float magnitude = std::sqrt(x * x + y * y);
+	float limit = magnitude > STICK_MAX ? STICK_MAX / magnitude : 1;
+	int actual_up_down = (y * cos_h + x * sin_h) * limit;
+	int actual_left_right = (y * sin_h - x * cos_h) * limit;
+	int actual_turn = turn;
+
+	commands.left_front = actual_up_down - actual_left_right + actual_turn;
+	commands.left_back = actual_up_down + actual_left_right + actual_turn;
+	commands.right_front = -actual_up_down - actual_left_right + actual_turn;
+	commands.right_back = -actual_up_down + actual_left_right + actual_turn;
+	return commands;
+}
+
+/*=============
+** HEADING HOLD
+=============*/
+HeadingHold::HeadingHold(float kp, float kd, float max_turn) : kp_(kp), kd_(kd), max_turn_(max_turn) {}
+
+void HeadingHold::reset(float heading){
+	if(std::isfinite(heading)) target_ = heading;
+}
+
+float HeadingHold::update(std::int32_t turnX, std::int32_t turnY, float heading, float gyro_rate){
+	if(std::isfinite(heading) == false) return 0;
+
+	//Pushed far enough, the stick's direction (clockwise from +y) is the new target
+	if(turnX * turnX + turnY * turnY >= HEADING_SET_MAGNITUDE * HEADING_SET_MAGNITUDE){
+		target_ = std::atan2((float)turnX, (float)turnY) * (float)(180 / PI);
+		if(target_ < 0) target_ += 360;
+	}
+
+	//The short way round, (-180, 180]
+	float error = target_ - heading;
+	if(error > 180) error -= 360;
+	if(error <= -180) error += 360;
+
+	//Without a rate reading it's P only
+	if(std::isfinite(gyro_rate) == false) gyro_rate = 0;
+
+	float turn = kp_ * error - kd_ * gyro_rate;
+	return std::min(std::max(turn, -max_turn_), max_turn_);
+}
+
+float HeadingHold::target() const{
+	return target_;
+}
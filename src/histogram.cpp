@@ -0,0 +1,75 @@
+#include "histogram.hpp"
+
+int RunHistogram::bucketFor(std::uint32_t us){
+	if(us < HISTOGRAM_LINEAR_BUCKETS * HISTOGRAM_LINEAR_WIDTH_US) return us / HISTOGRAM_LINEAR_WIDTH_US;
+
+	//Doubling buckets after the linear part
+	int bucket = HISTOGRAM_LINEAR_BUCKETS;
+	std::uint32_t edge = HISTOGRAM_LINEAR_BUCKETS * HISTOGRAM_LINEAR_WIDTH_US * 2;
+	while(us >= edge && bucket < HISTOGRAM_BUCKETS - 1){
+		edge *= 2;
+		bucket += 1;
+	}
+	return bucket;
+}
+
+std::uint32_t RunHistogram::bucketUpperEdge(int bucket){
+	if(bucket < HISTOGRAM_LINEAR_BUCKETS) return (bucket + 1) * HISTOGRAM_LINEAR_WIDTH_US;
+	return (HISTOGRAM_LINEAR_BUCKETS * HISTOGRAM_LINEAR_WIDTH_US) << (bucket - HISTOGRAM_LINEAR_BUCKETS + 1);
+}
+
+void RunHistogram::add(std::uint32_t us){
+	buckets_[bucketFor(us)] += 1;
+
+	if(count_ == 0 || us < min_) min_ = us;
+	if(us > max_) max_ = us;
+	total_ += us;
+	count_ += 1;
+}
+
+void RunHistogram::reset(){
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++) buckets_[i] = 0;
+	count_ = 0;
+	min_ = 0;
+	max_ = 0;
+	total_ = 0;
+}
+
+std::uint32_t RunHistogram::count() const{
+	return count_;
+}
+
+std::uint32_t RunHistogram::min() const{
+	return min_;
+}
+
+std::uint32_t RunHistogram::max() const{
+	return max_;
+}
+
+std::uint32_t RunHistogram::average() const{
+	if(count_ == 0) return 0;
+	return total_ / count_;
+}
+
+std::uint64_t RunHistogram::total() const{
+	return total_;
+}
+
+std::uint32_t RunHistogram::percentile(float percent) const{
+	if(count_ == 0) return 0;
+
+	std::uint32_t target = count_ * percent / 100.0f;
+	if(target < 1) target = 1;
+
+	std::uint32_t seen = 0;
+	for(int i = 0; i < HISTOGRAM_BUCKETS; i++){
+		seen += buckets_[i];
+		if(seen >= target){
+			//Never report more than what was actually measured
+			std::uint32_t edge = bucketUpperEdge(i);
+			return edge < max_ ? edge : max_;
+		}
+	}
+	return max_;
+}
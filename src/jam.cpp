@@ -0,0 +1,143 @@
+#include "jam.hpp"
+#include <cmath>
+#include <cstdio>
+
+JamDetector::JamDetector(const JamConfig& config) : config_(config) {}
+
+int JamDetector::update(const JamReading& reading, long time){
+	int direction = 0;
+	if(reading.command >= config_.min_command) direction = 1;
+	else if(reading.command <= -config_.min_command) direction = -1;
+
+	bool stalled = fabs(reading.velocity) < config_.max_velocity &&
+		(reading.current >= config_.min_current || reading.torque >= config_.min_torque || reading.over_current);
+
+	switch(state_){
+		case JAM_CLEAR:
+			if(stalled && direction != 0){
+				state_ = JAM_SUSPECT;
+				state_time_ = time;
+				direction_ = direction;
+			}
+			break;
+
+		case JAM_SUSPECT:
+			if(stalled == false || direction != direction_){
+				//Ball came free on its own (or after an earlier pulse)
+				if(retries_ > 0){
+					long recovery = time - jam_time_;
+					stats_.recovered += 1;
+					stats_.total_recovery_ms += recovery;
+					if(recovery > stats_.max_recovery_ms) stats_.max_recovery_ms = recovery;
+					retries_ = 0;
+				}
+				state_ = JAM_CLEAR;
+			}
+			else if(time - state_time_ >= config_.detect_ms){
+				if(retries_ >= config_.max_retries){
+					stats_.failed += 1;
+					state_ = JAM_FAILED;
+					break;
+				}
+				if(retries_ == 0){
+					stats_.jams += 1;
+					jam_time_ = time;
+				}
+				retries_ += 1;
+				state_ = JAM_REVERSING;
+				state_time_ = time;
+				return -direction_ * config_.reverse_speed;
+			}
+			break;
+
+		case JAM_REVERSING:
+			if(time - state_time_ < config_.reverse_ms){
+				return -direction_ * config_.reverse_speed;
+			}
+			state_ = JAM_RESUMING;
+			state_time_ = time;
+			break;
+
+		case JAM_RESUMING:
+			//Motor needs a moment to spin back up before the stall check means anything
+			if(time - state_time_ >= config_.resume_ms){
+				state_ = JAM_SUSPECT;
+				state_time_ = time;
+			}
+			break;
+
+		case JAM_FAILED:
+			//Stays failed until the code stops pushing the motor that way
+			if(direction != direction_){
+				retries_ = 0;
+				state_ = JAM_CLEAR;
+			}
+			break;
+	}
+
+	return JAM_NO_OVERRIDE;
+}
+
+JamState JamDetector::state() const{
+	return state_;
+}
+
+const JamStats& JamDetector::stats() const{
+	return stats_;
+}
+
+JamGuardedMotor::JamGuardedMotor(const std::uint8_t port, const JamConfig& config, const char* name)
+	: DeratedMotor(port, name), detector_(config) {}
+
+std::int32_t JamGuardedMotor::move(std::int32_t voltage) const{
+	output_mutex_.take(TIMEOUT_MAX);
+	command_ = voltage;
+	std::int32_t result = overridden_ ? 1 : DeratedMotor::move(voltage);
+	output_mutex_.give();
+	return result;
+}
+
+std::int32_t JamGuardedMotor::move_voltage(const std::int32_t voltage) const{
+	output_mutex_.take(TIMEOUT_MAX);
+	command_ = voltage * 127 / 12000;
+	std::int32_t result = overridden_ ? 1 : DeratedMotor::move_voltage(voltage);
+	output_mutex_.give();
+	return result;
+}
+
+void JamGuardedMotor::updateJam(){
+	JamReading reading;
+	reading.command = command_;
+	reading.velocity = get_actual_velocity();
+	reading.current = get_current_draw();
+	reading.torque = get_torque();
+	reading.over_current = is_over_current() == 1;
+
+	JamState previous = detector_.state();
+	int output = detector_.update(reading, pros::millis());
+
+	output_mutex_.take(TIMEOUT_MAX);
+	if(output != JAM_NO_OVERRIDE){
+		overridden_ = true;
+		DeratedMotor::move(output);
+	}
+	else if(overridden_){
+		//Pulse is over, back to whatever the code wants now
+		overridden_ = false;
+		DeratedMotor::move(command_);
+	}
+	output_mutex_.give();
+
+	if(detector_.state() != previous){
+		if(detector_.state() == JAM_REVERSING) printf("[jam] %s jammed, reversing\n", name());
+		else if(detector_.state() == JAM_FAILED) printf("[jam] %s still jammed, giving up\n", name());
+	}
+}
+
+JamState JamGuardedMotor::jamState() const{
+	return detector_.state();
+}
+
+const JamStats& JamGuardedMotor::jamStats() const{
+	return detector_.stats();
+}
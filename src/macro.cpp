@@ -0,0 +1,147 @@
+#include "macro.hpp"
+#include "drive_math.hpp"
+#include "api.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+struct MacroHeader{
+	std::uint32_t magic;
+	std::uint16_t version;
+	std::uint16_t period_ms;
+	std::uint32_t count;
+};
+
+//A heading of PROS_ERR_F is stored as this, playback then leaves the sticks alone
+#define MACRO_NO_HEADING 0xFFFF
+
+static std::int16_t clampInt16(float value){
+	if(std::isfinite(value) == false) return 0;
+	return std::lround(std::min(std::max(value, -32767.0f), 32767.0f));
+}
+
+static std::int32_t clampStick(float value){
+	return std::lround(std::min(std::max(value, (float)-STICK_MAX), (float)STICK_MAX));
+}
+
+//StickCurve zeroes anything within DRIVER_DEADBAND of centre, so on a centred stick the correction starts past
+//the deadband instead of being eaten by it
+static std::int32_t correctStick(std::int32_t value, float correction){
+	if(std::abs(value) <= DRIVER_DEADBAND && std::lround(correction) != 0) value = correction > 0 ? DRIVER_DEADBAND : -DRIVER_DEADBAND;
+	return clampStick(value + correction);
+}
+
+bool DriverMacro::recording() const{
+	return state_ == RECORDING;
+}
+
+bool DriverMacro::playing() const{
+	return state_ == PLAYING;
+}
+
+void DriverMacro::startRecording(std::uint32_t period_ms){
+	state_ = RECORDING;
+	period_ms_ = period_ms;
+	count_ = 0;
+}
+
+bool DriverMacro::record(const ControllerState& input, const SensorSnapshot& sensors){
+	if(state_ != RECORDING || count_ >= MACRO_MAX_SAMPLES) return false;
+
+	MacroSample& sample = samples_[count_];
+	bool known = std::isfinite(sensors.heading) && std::isfinite(sensors.pos_x) && std::isfinite(sensors.pos_y);
+	sample.pos_x = clampInt16(sensors.pos_x);
+	sample.pos_y = clampInt16(sensors.pos_y);
+	sample.heading = known ? std::lround(sensors.heading * 100) % 36000 : MACRO_NO_HEADING;
+	sample.buttons = input.buttons;
+	for(int i = 0; i < 4; i++) sample.analog[i] = clampStick(input.analog[i]);
+
+	count_ += 1;
+	return true;
+}
+
+bool DriverMacro::stopRecording(const char* path){
+	if(state_ != RECORDING) return false;
+	state_ = IDLE;
+	if(path == nullptr) return false;
+
+	std::FILE* file = std::fopen(path, "wb");
+	if(file == nullptr) return false;
+
+	MacroHeader header = {MACRO_MAGIC, MACRO_VERSION, (std::uint16_t)period_ms_, count_};
+	bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+		std::fwrite(samples_, sizeof(MacroSample), count_, file) == count_;
+	return std::fclose(file) == 0 && ok;
+}
+
+bool DriverMacro::load(const char* path){
+	state_ = IDLE;
+	count_ = 0;
+
+	std::FILE* file = std::fopen(path, "rb");
+	if(file == nullptr) return false;
+
+	MacroHeader header;
+	bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+		header.magic == MACRO_MAGIC && header.version == MACRO_VERSION && header.period_ms > 0 &&
+		header.count <= MACRO_MAX_SAMPLES &&
+		std::fread(samples_, sizeof(MacroSample), header.count, file) == header.count;
+	std::fclose(file);
+
+	if(ok){
+		period_ms_ = header.period_ms;
+		count_ = header.count;
+	}
+	return ok;
+}
+
+bool DriverMacro::startPlayback(std::uint32_t now){
+	if(state_ == RECORDING || count_ == 0) return false;
+	state_ = PLAYING;
+	start_ms_ = now;
+	return true;
+}
+
+bool DriverMacro::play(std::uint32_t now, const SensorSnapshot& sensors, ControllerState& input, float& heading){
+	//By time rather than by call, so a late tick doesn't put the rest of the run behind
+	std::uint32_t index = (now - start_ms_) / period_ms_;
+	heading = PROS_ERR_F;
+	if(state_ != PLAYING || index >= count_){
+		state_ = IDLE;
+		input = {{0, 0, 0, 0}, 0};
+		return false;
+	}
+
+	const MacroSample& sample = samples_[index];
+	for(int i = 0; i < 4; i++) input.analog[i] = sample.analog[i];
+	input.buttons = sample.buttons;
+	if(sample.heading != MACRO_NO_HEADING) heading = sample.heading / 100.0f;
+
+	bool known = std::isfinite(sensors.heading) && std::isfinite(sensors.pos_x) && std::isfinite(sensors.pos_y);
+	if(sample.heading == MACRO_NO_HEADING || known == false) return true;
+
+	//The left stick drives in field directions, so the position error goes straight onto it
+	float correction_x = (sample.pos_x - sensors.pos_x) * MACRO_POSITION_KP;
+	float correction_y = (sample.pos_y - sensors.pos_y) * MACRO_POSITION_KP;
+	float correction = std::sqrt(correction_x * correction_x + correction_y * correction_y);
+	if(correction > MACRO_MAX_CORRECTION){
+		correction_x *= MACRO_MAX_CORRECTION / correction;
+		correction_y *= MACRO_MAX_CORRECTION / correction;
+	}
+	input.analog[0] = correctStick(input.analog[0], correction_x);
+	input.analog[1] = correctStick(input.analog[1], correction_y);
+	return true;
+}
+
+void DriverMacro::stopPlayback(){
+	if(state_ == PLAYING) state_ = IDLE;
+}
+
+std::uint32_t DriverMacro::count() const{
+	return count_;
+}
+
+std::uint32_t DriverMacro::periodMs() const{
+	return period_ms_;
+}
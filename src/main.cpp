@@ -1,49 +1,41 @@
 #include "main.h"
 #include "math.h"
+#include "actions.hpp"
+#include "ball_sort.hpp"
+#include "calibration.hpp"
+#include "drive_math.hpp"
+#include "drive_tuning.hpp"
+#include "jam.hpp"
+#include "macro.hpp"
+#include "monitor.hpp"
+#include "motor_health.hpp"
+#include "ports.hpp"
+#include "profile.hpp"
+#include "recorder.hpp"
+#include "scheduler.hpp"
+#include "scoring.hpp"
+#include "screen.hpp"
+#include "sd_card.hpp"
+#include "segments.hpp"
+#include "sensors.hpp"
+#include "spsc_queue.hpp"
+#include "telemetry.hpp"
 #include <limits>
-
-/*=============
-** PORT DECLARATIONS
-=============*/
-#define LEFT_WHEEL_FRONT_PORT 13
-#define LEFT_WHEEL_BACK_PORT 17
-#define RIGHT_WHEEL_FRONT_PORT 8
-#define RIGHT_WHEEL_BACK_PORT 7
-
-#define FEEDER_MIDDLE_PORT 18
-#define FEEDER_TOP_PORT 6
-
-#define LEFT_INTAKE_PORT 16
-#define RIGHT_INTAKE_PORT 10
-
-#define IMU_PORT 19
-
-#define VISION_PORT 3
-
-#define LEFT_ENCODER_TOP 8
-#define LEFT_ENCODER_BOTTOM 7
-#define CENTER_ENCODER_TOP 6
-#define CENTER_ENCODER_BOTTOM 5
-#define RIGHT_ENCODER_TOP 4
-#define RIGHT_ENCODER_BOTTOM 3
-
-#define ANALOG_SENSOR_PORT1 1
-#define ANALOG_SENSOR_PORT2 2
-#define ANALOG_SENSOR_PORT3 9
+#include <optional>
 
 /*=============
 ** COMPONENT DECLARATION
 =============*/
-pros::Motor left_wheel_front (LEFT_WHEEL_FRONT_PORT);
-pros::Motor left_wheel_back (LEFT_WHEEL_BACK_PORT);
-pros::Motor right_wheel_front (RIGHT_WHEEL_FRONT_PORT);
-pros::Motor right_wheel_back (RIGHT_WHEEL_BACK_PORT);
+DeratedMotor left_wheel_front (LEFT_WHEEL_FRONT_PORT, "left_front");
+DeratedMotor left_wheel_back (LEFT_WHEEL_BACK_PORT, "left_back");
+DeratedMotor right_wheel_front (RIGHT_WHEEL_FRONT_PORT, "right_front");
+DeratedMotor right_wheel_back (RIGHT_WHEEL_BACK_PORT, "right_back");
 
-pros::Motor feeder_middle (FEEDER_MIDDLE_PORT);
-pros::Motor feeder_top (FEEDER_TOP_PORT);
+JamGuardedMotor feeder_middle (FEEDER_MIDDLE_PORT, FEEDER_JAM_CONFIG, "feeder_middle");
+JamGuardedMotor feeder_top (FEEDER_TOP_PORT, FEEDER_JAM_CONFIG, "feeder_top");
 
-pros::Motor left_intake (LEFT_INTAKE_PORT);
-pros::Motor right_intake (RIGHT_INTAKE_PORT);
+JamGuardedMotor left_intake (LEFT_INTAKE_PORT, INTAKE_JAM_CONFIG, "left_intake");
+JamGuardedMotor right_intake (RIGHT_INTAKE_PORT, INTAKE_JAM_CONFIG, "right_intake");
 
 pros::Imu inertial (IMU_PORT);
 
@@ -54,6 +46,7 @@ pros::ADIEncoder center_encoder (CENTER_ENCODER_TOP, CENTER_ENCODER_BOTTOM, fals
 pros::Vision vision_sensor (VISION_PORT);
 
 pros::Controller master (pros::E_CONTROLLER_MASTER);
+Screen screen (master);
 
 pros::ADIAnalogIn ball_limit_switch (ANALOG_SENSOR_PORT2);
 pros::ADIAnalogIn ball_limit_switch2 ({{ANALOG_SENSOR_PORT3, 'A'}});
@@ -61,10 +54,19 @@ pros::ADIAnalogIn goal_limit_switch (ANALOG_SENSOR_PORT1);
 
 #define SIDE 1
 
-#define PI 3.1415926
+//1 replays the driver macro saved on the SD card in autonomous() instead of the route there (skills)
+#define AUTONOMOUS_MACRO 0
 
-#define KPBASE 0.11
-#define KPBASETURN 0.1
+/*=============
+** VISION SIGNATURES
+=============*/
+//Signatures come from the vision utility, retune them on the field lighting
+#define RED_BALL_SIG 1
+#define BLUE_BALL_SIG 2
+
+//SIDE 1 is the red alliance
+#define OUR_BALL_SIG (SIDE == 1 ? RED_BALL_SIG : BLUE_BALL_SIG)
+#define THEIR_BALL_SIG (SIDE == 1 ? BLUE_BALL_SIG : RED_BALL_SIG)
 
 #define intake_speed 127
 #define conveyer_speed 127
@@ -72,19 +74,16 @@ pros::ADIAnalogIn goal_limit_switch (ANALOG_SENSOR_PORT1);
 /*=============
 ** GLOBAL POSITION/ANGLE VARIABLES USED FOR POSITION TRACKING
 =============*/
-float pos_x = 0;
-float pos_y = 0;
-
-float angle_ = 0;
-
 //Change in position is calculated based on difference between previous encoder based position (For position tracking everywhere)
-float prev_encoder_fwd_rev = 0;
-float prev_encoder_left_right = 0;
-float prev_angle = 0;
+Odometry odometry;
 
-//Used to see if bot is relatively close to goal position (fine-tuned value)
-float close_turn = 35;
-float close_move = 400;
+//Used to see if bot is relatively close to goal position (fine-tuned value, see drive_tuning.hpp)
+float close_turn = CLOSE_TURN;
+float close_move = CLOSE_MOVE;
+
+//Variables rather than the constants themselves so the simulator can try other values (sim --set)
+double kp_base = KPBASE;
+double kp_base_turn = KPBASETURN;
 
 bool wait_special = false;
 
@@ -95,8 +94,318 @@ int middleMotorVal = 0;
 
 long topEngagedTime;
 
+/*=============
+** SCHEDULING
+=============*/
+Scheduler scheduler;
+RuntimeMonitor runtime_monitor (scheduler);
+
+//Timing stats of the sensor update, for telemetry
+const LoopStats* sensors_loop_stats;
+
+//Timing stats for the loops that run inside competition tasks
+LoopStats* action_loop_stats;
+LoopStats* driver_loop_stats;
+LoopStats* drivetrain_loop_stats;
+LoopStats* indexer_loop_stats;
+
+//The sensor task (odometry) runs every 5 ms like the control loops (CONTROL_PERIOD_MS), so a control tick never
+//sees a pose more than 5 ms old. The inertial sensor only updates every 10 ms, every other pose reuses its heading
+#define ODOMETRY_PERIOD_MS 5
+#define DISPLAY_PERIOD_MS 50
+
+//Serial report only every few monitor updates, the screen gets every one
+#define MONITOR_SERIAL_EVERY 5
+
+/*=============
+** JAM RECOVERY
+=============*/
+JamGuardedMotor* jam_guarded_motors[] = {&feeder_middle, &feeder_top, &left_intake, &right_intake};
+
+//Motor data only updates every 10 ms, checking faster doesn't help
+#define JAM_CHECK_MS 10
+
+void jamUpdate(){
+	static int failed = 0;
+
+	int total_failed = 0;
+	for(JamGuardedMotor* motor : jam_guarded_motors){
+		motor->updateJam();
+		total_failed += motor->jamStats().failed;
+	}
+
+	//Tells the driver a jam couldn't be pulsed free
+	if(total_failed > failed) screen.rumble("---");
+	failed = total_failed;
+}
+
+//Prints jam statistics for every guarded motor over serial
+void reportJamStats(){
+	for(JamGuardedMotor* motor : jam_guarded_motors){
+		const JamStats& stats = motor->jamStats();
+		long average = stats.recovered > 0 ? stats.total_recovery_ms / stats.recovered : 0;
+		printf("[jam] %s: %d jams, %d recovered, %d failed, avg %ld ms, max %ld ms\n",
+			motor->name(), stats.jams, stats.recovered, stats.failed, average, stats.max_recovery_ms);
+	}
+}
+
+/*=============
+** MOTOR HEALTH
+=============*/
+MotorHealthMonitor health_monitor;
+
+DeratedMotor* const drivetrain_motors[] = {&left_wheel_front, &left_wheel_back, &right_wheel_front, &right_wheel_back};
+DeratedMotor* const conveyer_motors[] = {&feeder_middle, &feeder_top};
+DeratedMotor* const intake_motors[] = {&left_intake, &right_intake};
+
+//Group indices, in the order they're added in initialize()
+#define HEALTH_DRIVETRAIN 0
+#define HEALTH_CONVEYER 1
+#define HEALTH_INTAKE 2
+
+void healthUpdate(){
+	health_monitor.update();
+}
+
+/*=============
+** VISION SORTING
+=============*/
+//True while a driveSorted() segment runs: balls are stored or ejected based on what the vision sensor saw.
+//Driver control doesn't sort, the decisions only go to ConveyorAction
+bool auto_sort = false;
+
+BallSorter ball_sorter;
+pros::Mutex sorter_mutex;
+
+pros::vision_object_s_t our_objects[VISION_MAX_OBJECTS];
+pros::vision_object_s_t their_objects[VISION_MAX_OBJECTS];
+
+//Reads the vision sensor once per frame and feeds the ball sorter
+void visionUpdate(){
+	int our_count = vision_sensor.read_by_sig(0, OUR_BALL_SIG, VISION_MAX_OBJECTS, our_objects);
+	int their_count = vision_sensor.read_by_sig(0, THEIR_BALL_SIG, VISION_MAX_OBJECTS, their_objects);
+
+	//PROS_ERR is also returned when there are no objects of that signature
+	if(our_count == PROS_ERR || our_count < 0) our_count = 0;
+	if(their_count == PROS_ERR || their_count < 0) their_count = 0;
+
+	sorter_mutex.take(TIMEOUT_MAX);
+	ball_sorter.update(our_objects, our_count, their_objects, their_count);
+	sorter_mutex.give();
+}
+
+BallDecision nextBallDecision(){
+	sorter_mutex.take(TIMEOUT_MAX);
+	BallDecision decision = ball_sorter.front();
+	sorter_mutex.give();
+	return decision;
+}
+
+void takeBallDecision(){
+	sorter_mutex.take(TIMEOUT_MAX);
+	ball_sorter.pop();
+	sorter_mutex.give();
+}
+
 
 
+/*=============
+** SENSOR ACQUISITION
+=============*/
+SensorSnapshot latest_sensors;
+pros::Mutex sensors_mutex;
+
+//Updates the odometry pose from the tracking wheels and the inertial sensor readings in the snapshot
+void updatePosition(SensorSnapshot& snapshot){
+	PROFILE_SCOPE("odometry");
+
+	odometryUpdate(odometry, snapshot.left_encoder, snapshot.right_encoder, snapshot.center_encoder, snapshot.heading);
+
+	snapshot.pos_x = odometry.pos_x;
+	snapshot.pos_y = odometry.pos_y;
+	snapshot.heading = odometry.angle;
+}
+
+/*=============
+** CALIBRATION
+=============*/
+//Loaded from the SD card at startup, refreshed while the robot sits disabled
+CalibrationData calibration;
+CalibrationRefresh calibration_refresh;
+
+//Heading drift correction counts from when the heading was tared
+std::uint32_t heading_tared_at = 0;
+
+//Takes out the heading drift measured while the robot sat still
+float correctHeading(double heading, std::uint32_t time){
+	//PROS_ERR_F, left for the code downstream to see
+	if(isinf(heading)) return heading;
+
+	heading = fmod(heading - calibration.heading_drift * (time - heading_tared_at) / 1000.0, 360);
+	if(heading < 0) heading += 360;
+	return heading;
+}
+
+//get_gyro_rate().z times this is degrees/s clockwise, the way heading grows. It depends on how the sensor is
+//mounted; checkGyroSign() says on the first fast turn whether it's right
+#define GYRO_RATE_SIGN 1
+
+//Turns at least this fast (degrees/s) are far enough from noise to check the sign on, and how many it takes
+#define GYRO_SIGN_CHECK_RATE 60
+#define GYRO_SIGN_CHECK_SAMPLES 20
+
+float gyro_sign_heading = PROS_ERR_F;
+int gyro_sign_agree = 0;
+int gyro_sign_disagree = 0;
+
+//Compares the rate's sign with the way the heading actually moved since the last reading and reports it once
+void checkGyroSign(float heading, float gyro_rate){
+	float previous = gyro_sign_heading;
+	gyro_sign_heading = heading;
+	if(gyro_sign_agree + gyro_sign_disagree >= GYRO_SIGN_CHECK_SAMPLES) return;
+	if(isinf(heading) || isinf(previous) || fabs(gyro_rate) < GYRO_SIGN_CHECK_RATE) return;
+
+	//Heading wraps at 360, and only moves every other reading (the sensor updates every 10 ms)
+	float change = heading - previous;
+	if(change > 180) change -= 360;
+	if(change < -180) change += 360;
+	if(change == 0) return;
+
+	if((change > 0) == (gyro_rate > 0)) gyro_sign_agree += 1;
+	else gyro_sign_disagree += 1;
+
+	if(gyro_sign_agree + gyro_sign_disagree == GYRO_SIGN_CHECK_SAMPLES){
+		if(gyro_sign_disagree > gyro_sign_agree) printf("[imu] gyro rate turns the opposite way to the heading (%d of %d), flip GYRO_RATE_SIGN\n", gyro_sign_disagree, GYRO_SIGN_CHECK_SAMPLES);
+		else printf("[imu] gyro rate sign matches the heading (%d of %d)\n", gyro_sign_agree, GYRO_SIGN_CHECK_SAMPLES);
+	}
+}
+
+//Reads every device exactly once, updates the pose from those readings and publishes the snapshot
+void sensorUpdate(){
+	SensorSnapshot snapshot;
+	snapshot.time = pros::millis();
+
+	snapshot.left_encoder = lround(left_encoder.get_value() * calibration.left_scale);
+	snapshot.right_encoder = lround(right_encoder.get_value() * calibration.right_scale);
+	snapshot.center_encoder = lround(center_encoder.get_value() * calibration.center_scale);
+	snapshot.heading = correctHeading(inertial.get_heading(), snapshot.time);
+	snapshot.gyro_rate = GYRO_RATE_SIGN * (inertial.get_gyro_rate().z - calibration.gyro_bias);
+	checkGyroSign(snapshot.heading, snapshot.gyro_rate);
+
+	snapshot.top_position = feeder_top.get_position();
+	snapshot.middle_position = feeder_middle.get_position();
+
+	snapshot.ball_sensor = ball_limit_switch.get_value();
+	snapshot.ball_sensor2 = ball_limit_switch2.get_value();
+	snapshot.goal_sensor = goal_limit_switch.get_value();
+
+	updatePosition(snapshot);
+
+	sensors_mutex.take(TIMEOUT_MAX);
+	latest_sensors = snapshot;
+	sensors_mutex.give();
+}
+
+//Copy of the most recent snapshot, take one at the start of every control tick
+SensorSnapshot latestSensors(){
+	sensors_mutex.take(TIMEOUT_MAX);
+	SensorSnapshot snapshot = latest_sensors;
+	sensors_mutex.give();
+	return snapshot;
+}
+
+pros::task_t calibration_task = nullptr;
+
+//Measures the sensors again while the robot stays disabled and saves the result for the next boot. The values
+//in use don't change under the running code, the new ones only take effect after a restart
+void calibrationTask(void*){
+	CalibrationData refreshed = calibration;
+	calibration_refresh.reset();
+
+	std::uint32_t now = pros::millis();
+	while(pros::competition::is_disabled()){
+		if(calibration_refresh.sample(latestSensors(), inertial.get_gyro_rate().z, refreshed)){
+			if(pros::usd::is_installed() && saveCalibration(CALIBRATION_FILE, refreshed)){
+				printf("[cal] saved %s: drift %.4f deg/s, gyro bias %.3f deg/s\n", CALIBRATION_FILE,
+					refreshed.heading_drift, refreshed.gyro_bias);
+			}
+			break;
+		}
+		pros::Task::delay_until(&now, CALIBRATION_SAMPLE_MS);
+	}
+	calibration_task = nullptr;
+}
+
+//Writes the pose and ball sensor to the brain screen
+void displayUpdate(){
+	PROFILE_SCOPE("lcd");
+	SensorSnapshot sensors = latestSensors();
+
+	screen.setLine(1, "%f", sensors.pos_x);
+	screen.setLine(2, "%f", sensors.pos_y);
+	screen.setLine(3, "%d", sensors.ball_sensor2);
+
+	screen.setControllerLine(0, "X%5.0f Y%5.0f", sensors.pos_x, sensors.pos_y);
+	screen.setControllerLine(1, "H%5.1f %s", sensors.heading, auto_sort ? "SORT" : "");
+
+	screen.update();
+}
+
+//CPU budget on the brain screen every second and over serial every few seconds
+void monitorUpdate(){
+	static int updates = 0;
+
+	runtime_monitor.updateScreen(screen);
+	if(updates % MONITOR_SERIAL_EVERY == 0){
+		runtime_monitor.printReport();
+		profileReport();
+	}
+	updates += 1;
+}
+
+/*=============
+** TELEMETRY
+=============*/
+TelemetryStream telemetry;
+FlightRecorder flight_recorder;
+
+//Samples one frame for the serial telemetry stream and the SD card recorder, their writer tasks do the slow part
+void telemetryUpdate(){
+	SensorSnapshot sensors = latestSensors();
+	TelemetryFrame frame;
+
+	frame.values[TLM_TIME] = sensors.time;
+	frame.values[TLM_POS_X] = sensors.pos_x;
+	frame.values[TLM_POS_Y] = sensors.pos_y;
+	frame.values[TLM_HEADING] = sensors.heading * 100;
+	frame.values[TLM_LEFT_ENCODER] = sensors.left_encoder;
+	frame.values[TLM_RIGHT_ENCODER] = sensors.right_encoder;
+	frame.values[TLM_CENTER_ENCODER] = sensors.center_encoder;
+	frame.values[TLM_TOP_POSITION] = sensors.top_position;
+	frame.values[TLM_MIDDLE_POSITION] = sensors.middle_position;
+	frame.values[TLM_BALL_SENSOR] = sensors.ball_sensor;
+	frame.values[TLM_BALL_SENSOR2] = sensors.ball_sensor2;
+	frame.values[TLM_GOAL_SENSOR] = sensors.goal_sensor;
+
+	frame.values[TLM_LEFT_FRONT_MV] = left_wheel_front.get_voltage();
+	frame.values[TLM_LEFT_BACK_MV] = left_wheel_back.get_voltage();
+	frame.values[TLM_RIGHT_FRONT_MV] = right_wheel_front.get_voltage();
+	frame.values[TLM_RIGHT_BACK_MV] = right_wheel_back.get_voltage();
+	frame.values[TLM_FEEDER_TOP_MV] = feeder_top.get_voltage();
+	frame.values[TLM_FEEDER_MIDDLE_MV] = feeder_middle.get_voltage();
+	frame.values[TLM_LEFT_INTAKE_MV] = left_intake.get_voltage();
+	frame.values[TLM_RIGHT_INTAKE_MV] = right_intake.get_voltage();
+
+	frame.values[TLM_SENSORS_RUN_US] = sensors_loop_stats->last_run_us;
+	frame.values[TLM_ACTIONS_RUN_US] = action_loop_stats->last_run_us;
+	frame.values[TLM_DRIVETRAIN_RUN_US] = drivetrain_loop_stats->last_run_us;
+	frame.values[TLM_DRIVE_SCALE] = health_monitor.groupScale(HEALTH_DRIVETRAIN) * 100;
+	frame.values[TLM_MAX_TEMPERATURE] = health_monitor.maxTemperature();
+
+	telemetry.record(frame);
+	flight_recorder.record(frame);
+}
+
 void stopHold(){
 	left_wheel_front.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
 	left_wheel_back.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
@@ -128,135 +437,107 @@ void turnOffIntake(){
 }
 
 
-void drive(float goal_x, float goal_y, float goal_heading, float move_speed, float turn_speed, float position_tolerance, float angle_tolerance, bool store_our, bool poop, bool flag_change=false, bool fast_poop=false, bool extra_fast_poop=false){
-  //Angle bounds used to calculate when to stop turning (ex. +-3)
-	int upperAngleBound = goal_heading + angle_tolerance;
-	int lowerAngleBound = goal_heading - angle_tolerance;
-
-	long begin_time = pros::millis();
+/*=============
+** SEGMENT TIMING
+=============*/
+SegmentLog segment_log;
 
-	//Special conditions (If the angle is at 0 for example)
-	bool specialDown = false;
-	bool specialUp = false;
-	if(lowerAngleBound < 0){
-		lowerAngleBound = lowerAngleBound + 360;
-		specialDown = true;}
-	if(upperAngleBound > 360){
-		upperAngleBound = upperAngleBound - 360;
-		specialUp = true;}
+//Set while autonomous() runs, so disabled() knows when the field cut it short
+bool autonomous_running = false;
 
-		if(store_our == true && topEngaged == false){
-			if(ball_limit_switch.get_value() < 80){
-				feeder_middle.move(-conveyer_speed);
-				feeder_top.move(-90);
-			}
-			else{
-				if(ball_limit_switch2.get_value() < 1800 && middleEngaged == false){
-					feeder_middle.move(-conveyer_speed/10*8);
-					feeder_top.move(0);
-				}
-				else{
-					feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-					feeder_middle.move(0);
-					feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-					feeder_top.move(0);
-					middleEngaged = true;
-				}
-			}
-		}
-		else if(poop == true){
-			feeder_middle.move(-conveyer_speed/10*6.6);
-			feeder_top.move(conveyer_speed/10*6.5);
-		}
-		else if(fast_poop == true){
-			feeder_middle.move(-conveyer_speed/10*8.7);
-			feeder_top.move(conveyer_speed/10*7.7);
-		}
-		else if(extra_fast_poop == true){
-			feeder_middle.move(-conveyer_speed);
-			feeder_top.move(conveyer_speed);
-		}
+//Prints the run's segments over serial and saves them next to the flight recording
+void saveSegments(){
+	segment_log.writeCsv(stdout, "[seg] ");
+	if(pros::usd::is_installed()) segment_log.saveCsv(SD_DIR "segments.csv");
+}
 
-	bool flag = false;
+/*=============
+** ACTION RUNNER
+=============*/
+//Drives an action (or a whole all()/race()/sequence() tree of them) to completion from the calling task, one step per control tick
+void runAction(Action& action){
+	ControlRate rate (action_loop_stats);
 
-	long goalReachedTime = 0;
-	int goalReachedCount = 0;
+	action.start(latestSensors());
+	while(action.step(latestSensors()) == false){
+		rate.wait();
+	}
+	action.stop();
+}
 
-	/*Main loop that runs during a drive function
-		Specific conditions keep the drive function running until goal pos and heading is reached*/
-	while(
-		(sqrt(pow(goal_x-pos_x, 2)+pow(goal_y-pos_y, 2))>position_tolerance ||
-		(specialDown == true && ((angle_ <  lowerAngleBound && angle_ > goal_heading+180) || (angle_ > upperAngleBound && angle_ < goal_heading+180))) ||
-		(specialUp == true && ((angle_ > upperAngleBound && angle_ < goal_heading-180) || (angle_ < lowerAngleBound && angle_ > goal_heading-180))) ||
-		((specialUp == false && specialDown == false) && (angle_ > upperAngleBound || angle_ < lowerAngleBound))) && flag == false
-	){
-		if(ball_limit_switch.get_value() > 80 && poop == false && topEngaged == false){
-			topEngaged = true;
-			topEngagedTime = pros::millis();
-			motorVal = feeder_top.get_position()-130;
-		}
+template <typename A>
+void run(A&& action){
+	runAction(action);
+}
 
-		if(topEngaged == true){
-			if(feeder_top.get_position() < motorVal){
-				feeder_top.move(60 * (abs(feeder_top.get_position()-motorVal)/50 + 0.4));
-			}
-			else{
-				feeder_top.move(-60 * (abs(feeder_top.get_position()-motorVal)/50 + 0.4));
-			}
-		}
+/*=============
+** DRIVE ACTIONS
+=============*/
+//Drives to a field position and heading, the conveyer is left to ConveyorAction
+class DriveMotion : public Action{
+public:
+	DriveMotion(float goal_x, float goal_y, float goal_heading, float move_speed, float turn_speed, float position_tolerance, float angle_tolerance, bool flag_change=false)
+		: goal_x(goal_x), goal_y(goal_y), goal_heading(goal_heading), move_speed(move_speed), turn_speed(turn_speed),
+		position_tolerance(position_tolerance), angle_tolerance(angle_tolerance), flag_change(flag_change) {}
+
+	void start(const SensorSnapshot& sensors) override{
+	  //Angle bounds used to calculate when to stop turning (ex. +-3)
+		upperAngleBound = goal_heading + angle_tolerance;
+		lowerAngleBound = goal_heading - angle_tolerance;
+
+		//Special conditions (If the angle is at 0 for example)
+		specialDown = false;
+		specialUp = false;
+		if(lowerAngleBound < 0){
+			lowerAngleBound = lowerAngleBound + 360;
+			specialDown = true;}
+		if(upperAngleBound > 360){
+			upperAngleBound = upperAngleBound - 360;
+			specialUp = true;}
+
+		flag = false;
+		kicking = false;
+		goalReachedTime = 0;
+		goalReachedCount = 0;
+
+		finished = false;
+		segment = segment_log.begin("drive", pros::millis(), goal_x, goal_y, goal_heading);
+	}
 
-		if(topEngaged == true && store_our == true && middleEngaged == false && pros::millis() - topEngagedTime > 150){
-			if(ball_limit_switch2.get_value() < 1700){
-				feeder_middle.move(-conveyer_speed/10*9);
-			}
-			else{
-				middleEngaged = true;
-				middleMotorVal = feeder_middle.get_position();
+	/*Runs one tick of the drive
+		Specific conditions keep the drive running until goal pos and heading is reached*/
+	bool step(const SensorSnapshot& sensors) override{
+		if(kicking == true){
+			if(pros::millis()-small_begin_time > 75){
+				stopCoast();
+				kicking = false;
 			}
+			return false;
 		}
 
-		if(middleEngaged == true){
-			if(feeder_middle.get_position() < middleMotorVal){
-				feeder_middle.move(40 * (abs(feeder_middle.get_position()-middleMotorVal)/50 + 0.4));
-			}
-			else{
-				feeder_middle.move(-40 * (abs(feeder_middle.get_position()-middleMotorVal)/50 + 0.4));
-			}
+		if(!(
+			(sqrt(pow(goal_x-sensors.pos_x, 2)+pow(goal_y-sensors.pos_y, 2))>position_tolerance ||
+			(specialDown == true && ((sensors.heading <  lowerAngleBound && sensors.heading > goal_heading+180) || (sensors.heading > upperAngleBound && sensors.heading < goal_heading+180))) ||
+			(specialUp == true && ((sensors.heading > upperAngleBound && sensors.heading < goal_heading-180) || (sensors.heading < lowerAngleBound && sensors.heading > goal_heading-180))) ||
+			((specialUp == false && specialDown == false) && (sensors.heading > upperAngleBound || sensors.heading < lowerAngleBound))) && flag == false
+		)){
+			finished = true;
+			segment_log.end(segment, pros::millis(), flag ? SEGMENT_GOAL_SENSOR : SEGMENT_REACHED, sensors.pos_x, sensors.pos_y, sensors.heading);
+			return true;
 		}
 
-		// Position tracking stuff
-		float curr_encoder_fwd_rev = (right_encoder.get_value() + left_encoder.get_value()) / 2;
-		float curr_encoder_left_right = center_encoder.get_value();
-
-		angle_ = inertial.get_heading();
-		if(angle_ > 360) angle_ = 0;
-		if(angle_ < 0) angle_ = angle_+360;
-		pos_x = pos_x - (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * -sin(angle_*PI/180)) + ((curr_encoder_left_right-prev_encoder_left_right) * -cos(angle_*PI/180)));
-		pos_y = pos_y + (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * cos(angle_*PI/180)) - ((curr_encoder_left_right-prev_encoder_left_right) * sin(angle_*PI/180)));
-		prev_encoder_fwd_rev = curr_encoder_fwd_rev;
-		prev_encoder_left_right = curr_encoder_left_right;
-
-		pros::lcd::set_text(1, std::to_string(pos_x));
-		pros::lcd::set_text(2, std::to_string(pos_y));
-
+		PROFILE_START(angle, "drive.angle");
 
 		//Calculating reference angle
-		int reference_angle = atan((goal_x-pos_x)/(goal_y-pos_y)) * 180 / PI;
-		if((goal_y-pos_y) < 0) reference_angle = 180 + reference_angle;
-		if(reference_angle < 0) reference_angle = 360 + reference_angle;
+		int reference_angle = referenceAngle(goal_x, goal_y, sensors.pos_x, sensors.pos_y);
 
 		//Calcualating difference in angles
-		float difference = angle_ - reference_angle;
-		if(difference < 0) difference = 360 + difference;
-		difference = 360 - difference;
-		float turn_difference = angle_-goal_heading;
-		if(turn_difference > 180) turn_difference = 360-turn_difference;
-		if(turn_difference < -180) turn_difference = 360+turn_difference;
-		if(turn_difference < 0 && turn_difference > -180) turn_difference = -turn_difference;
+		float difference = driveDirection(sensors.heading, reference_angle);
+		float turn_difference = turnDifference(sensors.heading, goal_heading);
 
 		//Calculating difference for proportional calculations (PID allows smoother stops and error correcting)
-		int up_down_difference = goal_y-pos_y;
-		int left_right_difference = goal_x-pos_x;
+		int up_down_difference = goal_y-sensors.pos_y;
+		int left_right_difference = goal_x-sensors.pos_x;
 
 		//Motor speed changing vaiables (Moves the robot regardless of heading and relative to field)
 		float actual_up_down = 0;
@@ -266,13 +547,13 @@ void drive(float goal_x, float goal_y, float goal_heading, float move_speed, flo
 		if(up_down_difference < 0) up_down_difference = -up_down_difference;
 		if(left_right_difference < 0) left_right_difference = -left_right_difference;
 
-		if(sqrt(pow(goal_x-pos_x, 2)+pow(goal_y-pos_y, 2)) > close_move){
+		if(sqrt(pow(goal_x-sensors.pos_x, 2)+pow(goal_y-sensors.pos_y, 2)) > close_move){
 			actual_up_down = (cos(difference * PI / 180.0)*move_speed);
 			actual_left_right = (sin(difference * PI / 180.0)*move_speed);
 		}
 		else{
-			actual_up_down = (cos(difference * PI / 180.0)*move_speed) * (sqrt(pow(goal_x-pos_x, 2)+pow(goal_y-pos_y, 2))/close_move + KPBASE);
-			actual_left_right = (sin(difference * PI / 180.0)*move_speed) * (sqrt(pow(goal_x-pos_x, 2)+pow(goal_y-pos_y, 2))/close_move + KPBASE);
+			actual_up_down = (cos(difference * PI / 180.0)*move_speed) * (sqrt(pow(goal_x-sensors.pos_x, 2)+pow(goal_y-sensors.pos_y, 2))/close_move + kp_base);
+			actual_left_right = (sin(difference * PI / 180.0)*move_speed) * (sqrt(pow(goal_x-sensors.pos_x, 2)+pow(goal_y-sensors.pos_y, 2))/close_move + kp_base);
 		}
 
 		//Makes sure the speed values are within the motor input value spectrum (-12000 mV and 12000 mV)
@@ -286,7 +567,7 @@ void drive(float goal_x, float goal_y, float goal_heading, float move_speed, flo
 
 			//Slows down if close to goal heading and stays fast if it is away
 			if(turn_difference < close_turn){
-				actual_turn = (turn_speed*((turn_difference/(close_turn))+KPBASETURN));
+				actual_turn = (turn_speed*((turn_difference/(close_turn))+kp_base_turn));
 			}
 			else{
 				actual_turn = turn_speed;
@@ -301,77 +582,246 @@ void drive(float goal_x, float goal_y, float goal_heading, float move_speed, flo
 
 			/*Special conditions if angle bounds are less than 0 or greater than 360
 				Neccesary for proper turning and calculation*/
-			if((goal_heading > angle_+180) || (goal_heading > angle_-180 && angle_ > 180 && goal_heading < 180) ||
-				(goal_heading < angle_ && angle_-goal_heading < 180)) actual_turn = -actual_turn;
-			if(!(((upperAngleBound < angle_ || lowerAngleBound > angle_) && (specialUp == false && specialDown == false)) ||
-			((specialDown == true) && (lowerAngleBound > angle_ || (upperAngleBound < angle_ && (!angle_ > lowerAngleBound)))) ||
-			((specialUp == true) && (upperAngleBound < angle_ || (lowerAngleBound > angle_ && (!angle_ < upperAngleBound)))))) actual_turn = 0;
+			if((goal_heading > sensors.heading+180) || (goal_heading > sensors.heading-180 && sensors.heading > 180 && goal_heading < 180) ||
+				(goal_heading < sensors.heading && sensors.heading-goal_heading < 180)) actual_turn = -actual_turn;
+			if(!(((upperAngleBound < sensors.heading || lowerAngleBound > sensors.heading) && (specialUp == false && specialDown == false)) ||
+			((specialDown == true) && (lowerAngleBound > sensors.heading || (upperAngleBound < sensors.heading && (!sensors.heading > lowerAngleBound)))) ||
+			((specialUp == true) && (upperAngleBound < sensors.heading || (lowerAngleBound > sensors.heading && (!sensors.heading < upperAngleBound)))))) actual_turn = 0;
+
 
+		PROFILE_STOP(angle);
 
-    //Applying final values to motors for motion
+		//Applying final values to motors for motion
+		PROFILE_START(motors, "drive.motors");
 		left_wheel_front.move(actual_up_down + actual_left_right + actual_turn);
 		left_wheel_back.move(actual_up_down - actual_left_right + actual_turn);
 		right_wheel_front.move(-actual_up_down + actual_left_right + actual_turn);
 		right_wheel_back.move(-actual_up_down - actual_left_right + actual_turn);
+		PROFILE_STOP(motors);
 
-		if(goal_limit_switch.get_value() < 1700 && pros::millis()-goalReachedTime > 10){
+		if(sensors.goal_sensor < 1700 && pros::millis()-goalReachedTime > 10){
 			goalReachedTime = pros::millis();
 			goalReachedCount += 1;
 		}
 
-		if(goal_limit_switch.get_value() < 1700 && goal_heading != 92 && goalReachedCount > 3){
+		if(sensors.goal_sensor < 1700 && goal_heading != 92 && goalReachedCount > 3){
 			if(flag_change == true){
 				flag = true;
 
 				stopHold();
 			}
 		}
-		else if(goal_limit_switch.get_value() < 1700 && goal_heading == 92 && goalReachedCount > 3){
-			if(flag_change == true && pos_x > 850){
+		else if(sensors.goal_sensor < 1700 && goal_heading == 92 && goalReachedCount > 3){
+			if(flag_change == true && sensors.pos_x > 850){
 				flag = true;
 
-				bool small_flag = false;
-
+				//Short kick into the goal, finished by the next steps
 				left_wheel_front.move(-80);
 				left_wheel_back.move(-80);
 				right_wheel_front.move(80);
 				right_wheel_back.move(80);
 
-				long small_begin_time = pros::millis();
+				kicking = true;
+				small_begin_time = pros::millis();
+			}
+		}
 
-				float saved_x = pos_x;
+		return false;
+	}
 
-				while(small_flag == false){
-					// Position tracking stuff
-					float curr_encoder_fwd_rev = (right_encoder.get_value() + left_encoder.get_value()) / 2;
-					float curr_encoder_left_right = center_encoder.get_value();
+	void stop() override{
+		if(finished == false){
+			SensorSnapshot sensors = latestSensors();
+			segment_log.end(segment, pros::millis(), SEGMENT_CANCELLED, sensors.pos_x, sensors.pos_y, sensors.heading);
+		}
+	}
 
-					angle_ = inertial.get_heading();
-					if(angle_ > 360) angle_ = 0;
-					if(angle_ < 0) angle_ = angle_+360;
-					pos_x = pos_x - (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * -sin(angle_*PI/180)) + ((curr_encoder_left_right-prev_encoder_left_right) * -cos(angle_*PI/180)));
-					pos_y = pos_y + (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * cos(angle_*PI/180)) - ((curr_encoder_left_right-prev_encoder_left_right) * sin(angle_*PI/180)));
-					prev_encoder_fwd_rev = curr_encoder_fwd_rev;
-					prev_encoder_left_right = curr_encoder_left_right;
+private:
+	float goal_x;
+	float goal_y;
+	float goal_heading;
+	float move_speed;
+	float turn_speed;
+	float position_tolerance;
+	float angle_tolerance;
+	bool flag_change;
+
+	int upperAngleBound = 0;
+	int lowerAngleBound = 0;
+	bool specialDown = false;
+	bool specialUp = false;
 
-					if(pros::millis()-small_begin_time > 75){
-						small_flag = true;
-					}
+	bool flag = false;
+	bool kicking = false;
+	long small_begin_time = 0;
 
-					pros::delay(1);
+	long goalReachedTime = 0;
+	int goalReachedCount = 0;
+
+	int segment = -1;
+	bool finished = false;
+};
+
+//Runs the conveyer while driving: stores our balls, poops, or sorts them automatically. Never finishes on its own
+class ConveyorAction : public Action{
+public:
+	ConveyorAction(bool store_our, bool poop, bool fast_poop=false, bool extra_fast_poop=false, bool sort=false)
+		: store_our(store_our), poop(poop), fast_poop(fast_poop), extra_fast_poop(extra_fast_poop), sort(sort) {}
+
+	void start(const SensorSnapshot& sensors) override{
+		auto_sort = sort;
+
+		if(store_our == true && topEngaged == false){
+			if(sensors.ball_sensor < 80){
+				feeder_middle.move(-conveyer_speed);
+				feeder_top.move(-90);
+			}
+			else{
+				if(sensors.ball_sensor2 < 1800 && middleEngaged == false){
+					feeder_middle.move(-conveyer_speed/10*8);
+					feeder_top.move(0);
 				}
-				stopCoast();
+				else{
+					feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+					feeder_middle.move(0);
+					feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+					feeder_top.move(0);
+					middleEngaged = true;
+				}
+			}
+		}
+		else if(poop == true){
+			feeder_middle.move(-conveyer_speed/10*6.6);
+			feeder_top.move(conveyer_speed/10*6.5);
+		}
+		else if(fast_poop == true){
+			feeder_middle.move(-conveyer_speed/10*8.7);
+			feeder_top.move(conveyer_speed/10*7.7);
+		}
+		else if(extra_fast_poop == true){
+			feeder_middle.move(-conveyer_speed);
+			feeder_top.move(conveyer_speed);
+		}
+
+		ejecting = false;
+		eject_seen = false;
+		eject_begin_time = 0;
+	}
+
+	bool step(const SensorSnapshot& sensors) override{
+		//Automatic sorting (an opponent ball is only ejected while the top roller isn't holding one of ours)
+		if(sort == true){
+			BallDecision decision = nextBallDecision();
+
+			if(decision == BALL_EJECT && topEngaged == false){
+				if(ejecting == false){
+					ejecting = true;
+					eject_seen = false;
+					eject_begin_time = pros::millis();
+					feeder_middle.move(-conveyer_speed/10*6.6);
+					feeder_top.move(conveyer_speed/10*6.5);
+				}
+
+				//Ball has gone past the top sensor and out of the robot
+				if(sensors.ball_sensor > 80) eject_seen = true;
+				if((eject_seen == true && sensors.ball_sensor < 80) || pros::millis()-eject_begin_time > 800){
+					takeBallDecision();
+					ejecting = false;
+					restoreFeeders();
+				}
+			}
+			else if(decision == BALL_STORE && sensors.ball_sensor > 80 && topEngaged == false){
+				takeBallDecision();
+			}
+		}
+
+		if(sensors.ball_sensor > 80 && poop == false && topEngaged == false && ejecting == false){
+			topEngaged = true;
+			topEngagedTime = pros::millis();
+			motorVal = sensors.top_position-130;
+		}
+
+		if(topEngaged == true){
+			if(sensors.top_position < motorVal){
+				feeder_top.move(60 * (abs(sensors.top_position-motorVal)/50 + 0.4));
+			}
+			else{
+				feeder_top.move(-60 * (abs(sensors.top_position-motorVal)/50 + 0.4));
+			}
+		}
+
+		if(topEngaged == true && store_our == true && middleEngaged == false && pros::millis() - topEngagedTime > 150){
+			if(sensors.ball_sensor2 < 1700){
+				feeder_middle.move(-conveyer_speed/10*9);
+			}
+			else{
+				middleEngaged = true;
+				middleMotorVal = sensors.middle_position;
+				if(sort == true && nextBallDecision() == BALL_STORE) takeBallDecision();
+			}
+		}
+
+		if(middleEngaged == true){
+			if(sensors.middle_position < middleMotorVal){
+				feeder_middle.move(40 * (abs(sensors.middle_position-middleMotorVal)/50 + 0.4));
+			}
+			else{
+				feeder_middle.move(-40 * (abs(sensors.middle_position-middleMotorVal)/50 + 0.4));
 			}
 		}
 
-		/**/
+		return false;
+	}
 
-		//Saves resources
-    pros::delay(1);
+	void stop() override{
+		feeder_middle.move_voltage(0);
+		feeder_top.move_voltage(0);
+		auto_sort = false;
 	}
 
-	feeder_middle.move_voltage(0);
-	feeder_top.move_voltage(0);
+private:
+	//Back to what start() set the feeders doing once an eject has finished with them
+	void restoreFeeders(){
+		if(store_our == true){
+			feeder_middle.move(-conveyer_speed);
+			feeder_top.move(-90);
+		}
+		else if(fast_poop == true){
+			feeder_middle.move(-conveyer_speed/10*8.7);
+			feeder_top.move(conveyer_speed/10*7.7);
+		}
+		else if(extra_fast_poop == true){
+			feeder_middle.move(-conveyer_speed);
+			feeder_top.move(conveyer_speed);
+		}
+		else{
+			feeder_middle.move(0);
+			feeder_top.move(0);
+		}
+	}
+
+	bool store_our;
+	bool poop;
+	bool fast_poop;
+	bool extra_fast_poop;
+	bool sort;
+
+	bool ejecting = false;
+	bool eject_seen = false;
+	long eject_begin_time = 0;
+};
+
+void drive(float goal_x, float goal_y, float goal_heading, float move_speed, float turn_speed, float position_tolerance, float angle_tolerance, bool store_our, bool poop, bool flag_change=false, bool fast_poop=false, bool extra_fast_poop=false){
+	run(race(
+		DriveMotion(goal_x, goal_y, goal_heading, move_speed, turn_speed, position_tolerance, angle_tolerance, flag_change),
+		ConveyorAction(store_our, poop, fast_poop, extra_fast_poop)));
+}
+
+//drive() with vision sorting on: an opponent ball queued by the vision sensor is ejected instead of stored
+void driveSorted(float goal_x, float goal_y, float goal_heading, float move_speed, float turn_speed, float position_tolerance, float angle_tolerance, bool store_our, bool flag_change=false){
+	run(race(
+		DriveMotion(goal_x, goal_y, goal_heading, move_speed, turn_speed, position_tolerance, angle_tolerance, flag_change),
+		ConveyorAction(store_our, false, false, false, true)));
 }
 
 void turnOnIntake(){
@@ -421,370 +871,457 @@ void reverseIntakeOneFifth(){
 	right_intake.move(intake_speed/5);
 }
 
+//Applies the motor commands coming out of a scoring recipe
+void applyScoreOutput(const ScoreOutput& output){
+	if(output.hold_top) feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+	if(output.hold_middle) feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
 
-void scoreAndStore(float ball){
-	if(ball == 1){
-		feeder_top.move(-conveyer_speed);
-		feeder_middle.move(-conveyer_speed/10*8);
-
-		left_wheel_front.move(20);
-		left_wheel_back.move(20);
-		right_wheel_front.move(-20);
-		right_wheel_back.move(-20);
-	}
-	else if(ball == 2){
-		feeder_top.move(-conveyer_speed);
-		feeder_middle.move(-conveyer_speed/10*8);
-
-		left_wheel_front.move(30);
-		left_wheel_back.move(30);
-		right_wheel_front.move(-30);
-		right_wheel_back.move(-30);
-	}
-	else if(ball == 3){
-		feeder_top.move(-conveyer_speed);
-		feeder_middle.move(-conveyer_speed);
-	}
-	else if(ball == 4){
-		feeder_top.move(-conveyer_speed);
-		feeder_middle.move(-conveyer_speed/10*8);
-
-		left_wheel_front.move(20);
-		left_wheel_back.move(20);
-		right_wheel_front.move(-20);
-		right_wheel_back.move(-20);
-	}
-	else if(ball == 5){
-		feeder_top.move(-conveyer_speed);
-		feeder_middle.move(-conveyer_speed/2);
-
-		left_wheel_front.move(20);
-		left_wheel_back.move(20);
-		right_wheel_front.move(-20);
-		right_wheel_back.move(-20);
+	if(output.top_speed != SCORE_KEEP) feeder_top.move(output.top_speed);
+	if(output.middle_speed != SCORE_KEEP) feeder_middle.move(output.middle_speed);
+
+	if(output.creep_speed != SCORE_KEEP){
+		left_wheel_front.move(output.creep_speed);
+		left_wheel_back.move(output.creep_speed);
+		right_wheel_front.move(-output.creep_speed);
+		right_wheel_back.move(-output.creep_speed);
 	}
 
-	if(ball == 1){
-		bool flag = false;
-		long begin_time = pros::millis();
+	if(output.intake == SCORE_INTAKE_ON) turnOnIntake();
+	else if(output.intake == SCORE_INTAKE_OFF) turnOffIntake();
+}
 
-		bool phase1 = false;
-		bool phase2 = false;
-		bool phase3 = false;
 
-		int motorVal;
-		bool setMotorVal = false;
+/*Runs one scoring recipe, then leaves the conveyer held and empty. With hand_off it instead finishes as soon as
+	the recipe has counted its balls through (or timed out) and leaves the conveyer and intake running, for an
+	action that takes them over straight after (the settle time is only there to let the last ball clear)*/
+class ScoreAction : public Action{
+public:
+	explicit ScoreAction(float ball, bool hand_off = false) : recipe(findScoreRecipe(ball)), hand_off(hand_off) {}
 
-		while (flag == false) {
-			if(ball_limit_switch2.get_value() > 1800 && phase1 == false){
-				phase1 = true;
-			}
-			if(phase1 == true && ball_limit_switch2.get_value() < 1650 && phase2 == false && pros::millis()-begin_time > 200){
-				phase2 = true;
-				if(setMotorVal == false){
-					feeder_middle.move(-conveyer_speed/1.8);
-				}
-			}
-			if(phase2 == true && ball_limit_switch.get_value() > 180 && phase3 == false){
-				phase3 = true;
-			}
-			if(phase2 == true && ball_limit_switch2.get_value() > 1650 && setMotorVal == false && pros::millis()-begin_time > 150){
-				feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-				feeder_middle.move(0);
-				motorVal = feeder_middle.get_position()+230;
-				setMotorVal = true;
-			}
-			if(setMotorVal == true){
-				if(feeder_middle.get_position() < motorVal){
-					feeder_middle.move(127);
-				}
-				else{
-					feeder_middle.move(-127);
-				}
-			}
-			if(pros::millis()-begin_time > 600){
-				turnOffIntake();
-			}
-			if(pros::millis() - begin_time > 760){
-				flag = true;
-			}
-			pros::delay(1);
+	//The goal pose is where scoring started, the error is how far the creep moved the robot
+	void start(const SensorSnapshot& sensors) override{
+		segment = segment_log.begin("score", pros::millis(), sensors.pos_x, sensors.pos_y, sensors.heading);
+		finished = false;
+
+		if(recipe == nullptr){
+			finished = true;
+			segment_log.end(segment, pros::millis(), SEGMENT_SKIPPED, sensors.pos_x, sensors.pos_y, sensors.heading);
+			return;
 		}
-		feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-		feeder_top.move(0);
+
+		interpreter.emplace(*recipe);
+		applyScoreOutput(interpreter->start());
+		begin_time = pros::millis();
 	}
-	else if(ball == 2){
-		bool flag = false;
-		long begin_time = pros::millis();
 
-		bool phase1 = false;
-		bool phase2 = false;
-		bool phase3 = false;
+	bool step(const SensorSnapshot& sensors) override{
+		if(recipe == nullptr) return true;
 
-		int motorVal;
-		bool setMotorVal = false;
+		ScoreInput input;
+		input.elapsed = pros::millis()-begin_time;
+		input.ball_sensor = sensors.ball_sensor;
+		input.ball_sensor2 = sensors.ball_sensor2;
+		input.middle_position = sensors.middle_position;
 
-		turnOffIntake();
+		applyScoreOutput(interpreter->step(input));
+		if(interpreter->done() == false && (hand_off == false || interpreter->counted() == false)) return false;
 
-		while (flag == false) {
-			if(ball_limit_switch2.get_value() > 1800 && phase1 == false){
-				phase1 = true;
-			}
-			if(phase1 == true && ball_limit_switch2.get_value() < 1650 && phase2 == false && pros::millis()-begin_time > 200){
-				phase2 = true;
-			}
-			if(phase2 == true && ball_limit_switch.get_value() > 180 && phase3 == false){
-				if(setMotorVal == false){
-					feeder_middle.move(-conveyer_speed/1.5);
-				}
-				phase3 = true;
-			}
-			if(phase2 == true && ball_limit_switch2.get_value() > 1650 && setMotorVal == false && pros::millis()-begin_time > 100){
-				feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-				feeder_middle.move(0);
-				motorVal = feeder_middle.get_position()+270;
-				setMotorVal = true;
-			}
-			if(setMotorVal == true){
-				if(feeder_middle.get_position() < motorVal){
-					feeder_middle.move(127);
-				}
-				else{
-					feeder_middle.move(-127);
-				}
-			}
-			if(pros::millis()-begin_time < 340 && pros::millis()-begin_time > 180){
-				turnOnIntake();
-			}
-			else if(pros::millis()-begin_time > 340){
-				turnOffIntake();
-			}
-			if(pros::millis() - begin_time > 800){
-				flag = true;
-			}
-			pros::delay(1);
+		finished = true;
+		segment_log.end(segment, pros::millis(), SEGMENT_DONE, sensors.pos_x, sensors.pos_y, sensors.heading);
+		return true;
+	}
+
+	void stop() override{
+		if(recipe == nullptr) return;
+
+		if(finished == false){
+			SensorSnapshot sensors = latestSensors();
+			segment_log.end(segment, pros::millis(), SEGMENT_CANCELLED, sensors.pos_x, sensors.pos_y, sensors.heading);
 		}
+
+		topEngaged = false;
+		middleEngaged = false;
+		if(hand_off == true) return;
+
 		feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
 		feeder_top.move(0);
+		feeder_middle.move(0);
+		turnOffIntake();
 	}
-	else if(ball == 3){
-		bool flag = false;
-		long begin_time = pros::millis();
 
-		bool phase1 = false;
-		bool phase2 = false;
-		bool phase3 = false;
+private:
+	const ScoreRecipe* recipe;
+	bool hand_off;
+	std::optional<ScoreInterpreter> interpreter;
+	long begin_time = 0;
 
-		int motorVal;
-		bool setMotorVal = false;
+	int segment = -1;
+	bool finished = false;
+};
 
-		bool startedScoring = false;
-		long startedScoringTime;
+void scoreAndStore(float ball){
+	run(ScoreAction(ball));
+}
 
-		int count = 0;
 
-		bool engaged = false;
+/*=============
+** DRIVER CONTROL
+=============*/
+/*opcontrol() only polls the controller and hands commands to the drivetrain and indexer tasks through SPSC
+	queues, so nothing the input side does (or the screen) can hold up motor output.*/
+
+//Raw joystick values for one input poll
+struct DriveCommand{
+	std::int32_t up_down;
+	std::int32_t left_right;
+	std::int32_t turnX;
+	std::int32_t turnY;
+	//Heading for the hold to target unless the right stick sets one (macro playback), PROS_ERR_F to keep its own
+	float hold_heading;
+};
+
+struct IndexerCommand{
+	int intake;        //1 in, -1 out, 0 stopped
+	bool conveyer;
+};
+
+SpscQueue<DriveCommand, 8> drive_commands;
+SpscQueue<IndexerCommand, 8> indexer_commands;
+
+//Drivetrain stops if it hears nothing from opcontrol() for this long
+#define DRIVER_COMMAND_TIMEOUT_MS 100
+
+const StickCurve driver_sticks (DRIVER_DEADBAND, DRIVER_EXPO);
+HeadingHold heading_hold;
+
+//UP starts and stops recording a macro, DOWN plays the saved one back (and stops it early)
+#define MACRO_RECORD_BUTTON pros::E_CONTROLLER_DIGITAL_UP
+#define MACRO_PLAY_BUTTON pros::E_CONTROLLER_DIGITAL_DOWN
+
+DriverMacro driver_macro;
+
+void driverDrive(const DriveCommand& command){
+	PROFILE_START(math, "driver.math");
+
+	//Getting current angle
+	SensorSnapshot sensors = latestSensors();
+	heading_hold.reset(command.hold_heading);
+	float turn = heading_hold.update(command.turnX, command.turnY, sensors.heading, sensors.gyro_rate);
+	WheelCommands wheels = fieldCentricDrive(driver_sticks, command.up_down, command.left_right, turn, sensors.heading);
+
+	PROFILE_STOP(math);
+
+	//Applying final values to motors for motion
+	PROFILE_SCOPE("driver.motors");
+	left_wheel_front.move(wheels.left_front);
+	left_wheel_back.move(wheels.left_back);
+	right_wheel_front.move(wheels.right_front);
+	right_wheel_back.move(wheels.right_back);
+}
 
-		turnOffIntake();
+//Blocking consumer, wakes up as soon as opcontrol() pushes a command
+void drivetrainTask(void*){
+	drive_commands.setConsumer(pros::c::task_get_current());
+	bool active = false;
+	std::uint64_t previous_us = 0;
+
+	while(true){
+		DriveCommand command;
+		if(drive_commands.popWait(command, DRIVER_COMMAND_TIMEOUT_MS)){
+			//Only the newest stick position matters
+			drive_commands.popLatest(command);
+
+			//Hold wherever the robot was left rather than swinging back to the last target
+			if(active == false) heading_hold.reset(latestSensors().heading);
+
+			std::uint64_t start_us = pros::micros();
+			driverDrive(command);
+			recordRun(*drivetrain_loop_stats, previous_us > 0 ? start_us - previous_us : 0, pros::micros() - start_us);
+			previous_us = start_us;
+			active = true;
+		}
+		else if(active == true){
+			//opcontrol() has stopped (disabled or switched mode), don't leave the wheels running
+			active = false;
+			previous_us = 0;
+			if(pros::competition::is_autonomous() == false) stopCoast();
+		}
+	}
+}
 
-		while (flag == false) {
+//Non-blocking consumer, runs the intake and conveyer at the control period
+void indexerTask(void*){
+	ControlRate rate (indexer_loop_stats);
+	IndexerCommand command = {0, false};
+	long last_command_time = 0;
+	bool active = false;
+
+	while(true){
+		if(indexer_commands.popLatest(command)){
+			last_command_time = pros::millis();
+			active = true;
+		}
 
-			if(ball_limit_switch2.get_value() > 1800 && phase1 == false){
-				phase1 = true;
-			}
-			if(phase1 == true && ball_limit_switch2.get_value() < 1650 && phase2 == false && pros::millis()-begin_time > 200){
-				phase2 = true;
-				if(setMotorVal == false){
-					feeder_middle.move(-conveyer_speed/1.8);
-				}
-				startedScoring = true;
-				startedScoringTime = pros::millis();
-			}
-			if(phase2 == true && ball_limit_switch.get_value() > 180 && phase3 == false){
-				phase3 = true;
-			}
-			if(phase2 == true && ball_limit_switch2.get_value() > 1650 && setMotorVal == false && pros::millis()-begin_time > 300){
-				feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+		if(active == true && pros::millis()-last_command_time > DRIVER_COMMAND_TIMEOUT_MS){
+			active = false;
+			if(pros::competition::is_autonomous() == false){
+				turnOffIntake();
 				feeder_middle.move(0);
-				motorVal = feeder_middle.get_position()+300;
-				setMotorVal = true;
-			}
-			if(startedScoring == true && pros::millis()-startedScoringTime < 500){
-				if(setMotorVal == true){
-					if(feeder_middle.get_position() < motorVal){
-						feeder_middle.move(conveyer_speed);
-					}
-					else{
-						feeder_middle.move(-conveyer_speed);
-					}
-				}
-			}
-			else if(startedScoring == true && pros::millis()-startedScoringTime > 500){
-				feeder_middle.move(-conveyer_speed);
-				feeder_top.move(conveyer_speed);
+				feeder_top.move(0);
 			}
+		}
 
-			if(pros::millis()-begin_time > 50){
-				turnOnIntake();
+		if(active == true){
+			//Intake subsytem controls
+			if(command.intake == 1){
+				left_intake.move(intake_speed);
+				right_intake.move(-intake_speed);
 			}
-
-			if(startedScoring == true && phase3 == true && ball_limit_switch2.get_value() > 1700 && engaged == false && pros::millis()-startedScoringTime > 550){
-				engaged = true;
-				count += 1;
-			}
-
-			if(startedScoring == true && phase3 == true && ball_limit_switch2.get_value() < 1700 && engaged == true && pros::millis()-startedScoringTime > 550){
-				engaged = false;
+			else if(command.intake == -1){
+				left_intake.move(-intake_speed);
+				right_intake.move(intake_speed);
 			}
+			else{
+				left_intake.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+				left_intake.move(0);
+				right_intake.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+				right_intake.move(0);}
 
-			if(count >= 2){
-				bool small_flag = false;
-				long small_start_time = pros::millis();
-				while(small_flag == false){
-					if(pros::millis()-small_start_time > 60){
-						small_flag = true;
-					}
-					if(engaged == false){
-						small_flag = true;
-					}
-				}
-				flag = true;
-			}
-			else if(pros::millis()-begin_time > 2200){
-				flag = true;
+			if(command.conveyer){
+				feeder_middle.move(-conveyer_speed);
+				feeder_top.move(-conveyer_speed);
 			}
-			pros::delay(1);
-		}
-		feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-		feeder_top.move(0);
-
-	}
-	else if(ball == 4){
-		bool flag = false;
-		long begin_time = pros::millis();
-
-		bool phase1 = false;
-
-		while (flag == false) {
-			if(ball_limit_switch2.get_value() > 1700 && pros::millis() - begin_time > 150){
-				feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+			else{
+				//Stops the conveyer and indexer if button is not clicked
 				feeder_middle.move(0);
-
-				phase1 = true;
-
-				feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
 				feeder_top.move(0);
 			}
-			if(pros::millis() - begin_time > 600){
-				flag = true;
-			}
 		}
 
-		feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-		feeder_top.move(0);
-		turnOffIntake();
+		rate.wait();
 	}
-	else if(ball == 5){
-		bool flag = false;
-		long begin_time = pros::millis();
+}
 
-		bool stored = false;
+//Every stick and button of the master controller
+ControllerState readController(){
+	ControllerState input;
+	input.analog[0] = master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_X);
+	input.analog[1] = master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+	input.analog[2] = master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
+	input.analog[3] = master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
+
+	input.buttons = 0;
+	for(int button = pros::E_CONTROLLER_DIGITAL_L1; button <= pros::E_CONTROLLER_DIGITAL_A; button++){
+		if(master.get_digital((pros::controller_digital_e_t)button)) input.buttons |= CONTROLLER_BUTTON(button);
+	}
+	return input;
+}
 
-		while (flag == false) {
+//Hands one tick of controller input to the drivetrain and indexer tasks, live or from a macro (with the heading
+//it recorded)
+void driverControl(const ControllerState& input, float hold_heading = PROS_ERR_F){
+	DriveCommand drive_command;
+	drive_command.up_down = input.analog[1];
+	drive_command.left_right = input.analog[0];
+	drive_command.turnX = input.analog[2];
+	drive_command.turnY = input.analog[3];
+	drive_command.hold_heading = hold_heading;
+	drive_commands.push(drive_command);
+
+	IndexerCommand indexer_command;
+	indexer_command.intake = 0;
+	if(input.buttons & CONTROLLER_BUTTON(pros::E_CONTROLLER_DIGITAL_R2)) indexer_command.intake = 1;
+	else if(input.buttons & CONTROLLER_BUTTON(pros::E_CONTROLLER_DIGITAL_R1)) indexer_command.intake = -1;
+	indexer_command.conveyer = input.buttons & CONTROLLER_BUTTON(pros::E_CONTROLLER_DIGITAL_L2);
+	indexer_commands.push(indexer_command);
+}
 
-			if(ball_limit_switch2.get_value() > 1700 && stored == false){
-				feeder_middle.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-				feeder_middle.move(0);
+void saveMacro(){
+	std::uint32_t count = driver_macro.count();
+	if(driver_macro.stopRecording(pros::usd::is_installed() ? MACRO_FILE : nullptr)){
+		printf("[macro] saved %lu ticks (%lu ms) to %s\n", (unsigned long)count, (unsigned long)(count * driver_macro.periodMs()), MACRO_FILE);
+	}
+	else{
+		printf("[macro] couldn't save %s\n", MACRO_FILE);
+	}
+}
 
-				bool small_flag = false;
-				long small_begin_time = pros::millis();
-
-				while(small_flag == false){
-					if(pros::millis()-small_begin_time > 250){
-						small_flag = true;
-					}
-
-					// Position tracking stuff
-					float curr_encoder_fwd_rev = (right_encoder.get_value() + left_encoder.get_value()) / 2;
-					float curr_encoder_left_right = center_encoder.get_value();
-
-					angle_ = inertial.get_heading();
-					if(angle_ > 360) angle_ = 0;
-					if(angle_ < 0) angle_ = angle_+360;
-					pos_x = pos_x - (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * -sin(angle_*PI/180)) + ((curr_encoder_left_right-prev_encoder_left_right) * -cos(angle_*PI/180)));
-					pos_y = pos_y + (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * cos(angle_*PI/180)) - ((curr_encoder_left_right-prev_encoder_left_right) * sin(angle_*PI/180)));
-					prev_encoder_fwd_rev = curr_encoder_fwd_rev;
-					prev_encoder_left_right = curr_encoder_left_right;
-				}
+bool loadMacro(){
+	std::uint64_t start_us = pros::micros();
+	if(driver_macro.load(MACRO_FILE) == false){
+		printf("[macro] no macro in %s\n", MACRO_FILE);
+		return false;
+	}
+	printf("[macro] loaded %lu ticks in %lu us\n", (unsigned long)driver_macro.count(), (unsigned long)(pros::micros() - start_us));
+	return true;
+}
 
-				feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-				feeder_top.move(0);
-				stored = true;
-			}
-			if(pros::millis() - begin_time > 400){
-				turnOffIntake();
-			}
-			if(pros::millis() - begin_time > 450){
-				flag = true;
-			}
+void macroButtons(){
+	if(master.get_digital_new_press(MACRO_RECORD_BUTTON)){
+		if(driver_macro.recording()){
+			saveMacro();
 		}
+		else{
+			driver_macro.stopPlayback();
+			driver_macro.startRecording(CONTROL_PERIOD_MS);
+			printf("[macro] recording\n");
+		}
+	}
 
-		feeder_top.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-		feeder_top.move(0);
+	if(master.get_digital_new_press(MACRO_PLAY_BUTTON) && driver_macro.recording() == false){
+		if(driver_macro.playing()) driver_macro.stopPlayback();
+		else if(loadMacro()) driver_macro.startPlayback(pros::millis());
 	}
-	feeder_middle.move(0);
-	feeder_top.move(0);
-	topEngaged = false;
-	middleEngaged = false;
-	turnOffIntake();
+}
+
+//Autonomous skills: the saved macro, through the same pipeline as opcontrol()
+void playMacro(){
+	if(loadMacro() == false) return;
+
+	ControlRate rate (driver_loop_stats);
+	ControllerState input;
+	float heading;
+	driver_macro.startPlayback(pros::millis());
+	while(driver_macro.play(pros::millis(), latestSensors(), input, heading)){
+		driverControl(input, heading);
+		rate.wait();
+	}
+	//Centred sticks, stops the robot
+	driverControl(input);
 }
 
 
+/*=============
+** STARTUP
+=============*/
+//The sensor takes a moment after reset() to start reporting that it's calibrating
+#define IMU_STATUS_DELAY_MS 50
+//Calibration normally takes about 2 s, give up well after that
+#define IMU_CALIBRATION_TIMEOUT_MS 5000
+#define IMU_POLL_MS 10
+
+//Polls the inertial sensor until it's done calibrating instead of sleeping for the worst case
+void waitForImuCalibration(std::uint32_t start){
+	while(pros::millis() - start < IMU_STATUS_DELAY_MS || inertial.is_calibrating()){
+		if(pros::millis() - start > IMU_CALIBRATION_TIMEOUT_MS) break;
+		pros::delay(IMU_POLL_MS);
+	}
+
+	unsigned long duration = pros::millis() - start;
+	if(inertial.get_status() == pros::c::E_IMU_STATUS_ERROR) printf("[init] inertial sensor not responding after %lu ms\n", duration);
+	else if(inertial.is_calibrating()) printf("[init] inertial sensor still calibrating after %lu ms, carrying on\n", duration);
+	else printf("[init] sensors calibrated in %lu ms\n", duration);
+}
+
 void initialize() {
 	//Initializing the screen for writing purposes
 	pros::lcd::initialize();
 
-	//Resetting inertial sensor to work with current heading
+	//Resetting inertial sensor to work with current heading, it calibrates in the background while the rest starts up
+	std::uint32_t calibration_start = pros::millis();
 	inertial.reset();
-	pros::delay(3500);
 
+	//What the last disabled period measured. The line sensors are read raw, so they need no calibrate() (0.5 s each)
+	std::uint64_t load_start = pros::micros();
+	if(loadCalibration(CALIBRATION_FILE, calibration)){
+		printf("[cal] loaded %s in %lu us (%lu refreshes)\n", CALIBRATION_FILE, (unsigned long)(pros::micros() - load_start),
+			(unsigned long)calibration.refreshes);
+	}
+
+	//Ball color signatures for sorting
+	pros::vision_signature_s_t red_signature = pros::Vision::signature_from_utility(RED_BALL_SIG, 7457, 9417, 8437, -1071, -539, -805, 3.0, 0);
+	pros::vision_signature_s_t blue_signature = pros::Vision::signature_from_utility(BLUE_BALL_SIG, -3385, -2757, -3071, 9103, 11255, 10179, 3.0, 0);
+	vision_sensor.set_signature(RED_BALL_SIG, &red_signature);
+	vision_sensor.set_signature(BLUE_BALL_SIG, &blue_signature);
+
+
+	health_monitor.addGroup("drivetrain", drivetrain_motors, 4);
+	health_monitor.addGroup("conveyer", conveyer_motors, 2);
+	health_monitor.addGroup("intake", intake_motors, 2);
+
+	//Background subsystems
+	sensors_loop_stats = scheduler.add("sensors", sensorUpdate, ODOMETRY_PERIOD_MS, TASK_PRIORITY_DEFAULT+1);
+	scheduler.add("jam", jamUpdate, JAM_CHECK_MS, TASK_PRIORITY_DEFAULT);
+	scheduler.add("vision", visionUpdate, VISION_FRAME_MS, TASK_PRIORITY_DEFAULT);
+	scheduler.add("display", displayUpdate, DISPLAY_PERIOD_MS, TASK_PRIORITY_MIN+1);
+	scheduler.add("monitor", monitorUpdate, MONITOR_PERIOD_MS, TASK_PRIORITY_MIN+1);
+	scheduler.add("telemetry", telemetryUpdate, TELEMETRY_PERIOD_MS, TASK_PRIORITY_DEFAULT);
+	scheduler.add("health", healthUpdate, HEALTH_PERIOD_MS, TASK_PRIORITY_MIN+1);
+
+	action_loop_stats = scheduler.addLoop("actions", CONTROL_PERIOD_MS);
+	driver_loop_stats = scheduler.addLoop("input", CONTROL_PERIOD_MS);
+	drivetrain_loop_stats = scheduler.addLoop("drivetrn", CONTROL_PERIOD_MS);
+	indexer_loop_stats = scheduler.addLoop("indexer", CONTROL_PERIOD_MS);
+
+	//Odometry needs a calibrated heading before the sensor task starts
+	waitForImuCalibration(calibration_start);
 	inertial.tare();
+	heading_tared_at = pros::millis();
 
-	//Calibrating sensors
-	ball_limit_switch.calibrate();
-	goal_limit_switch.calibrate();
+	telemetry.start();
+	if(flight_recorder.start() == false) printf("[rec] no SD card, not recording\n");
+	scheduler.start();
 
-	pros::delay(3500);
+	//Driver control consumers, idle until opcontrol() starts sending commands
+	pros::Task drivetrain_task (drivetrainTask, nullptr, TASK_PRIORITY_DEFAULT+1, TASK_STACK_DEPTH_DEFAULT, "drivetrain");
+	pros::Task indexer_task (indexerTask, nullptr, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "indexer");
 }
 
-void disabled() {}
+void disabled() {
+	//The field may have cut autonomous() short before it could save its segments and flush
+	if(autonomous_running){
+		autonomous_running = false;
+		saveSegments();
+	}
+	flight_recorder.flush();
+
+	//The field ends driver control by disabling, a recording still running is the run
+	if(driver_macro.recording()) saveMacro();
+
+	//A cancelled autonomous() can't have left sorting on for driver control
+	auto_sort = false;
+
+	//Standing still is free calibration time
+	if(calibration_task == nullptr){
+		pros::Task task (calibrationTask, nullptr, TASK_PRIORITY_MIN+1, TASK_STACK_DEPTH_DEFAULT, "calibration");
+		calibration_task = task;
+	}
+}
 
 void competition_initialize() {
 
 }
 
 void autonomous(){
+	if(AUTONOMOUS_MACRO){
+		playMacro();
+		return;
+	}
+
   long initial_time = pros::millis();
+	segment_log.reset(initial_time);
+	autonomous_running = true;
 
+	//Vision sorting runs in the segments that take balls in (driveSorted), the poop segments run without it
 	turnOnIntake();
 
-	drive(0, 250, 0, 127, 40, 100, 6, false, false);
+	driveSorted(0, 250, 0, 127, 40, 100, 6, false);
 
 	pros::delay(200);
 
-	drive(-720, 300, 237, 127, 127, 40, 6, true, false);
+	driveSorted(-720, 300, 237, 127, 127, 40, 6, true);
 
-	drive(-1100, 100, 236, 120, 60, 1, 3, true, false, true);
+	driveSorted(-1100, 100, 236, 120, 60, 1, 3, true, true);
 
 	scoreAndStore(1);
 
 	reverseIntakeOneThird();
 
-	drive(-680, 410, 230, 127, 127, 70, 6, false, false);
+	driveSorted(-680, 410, 230, 127, 127, 70, 6, false);
 
 	turnOnIntake();
 
-	drive(-570, 520, 231, 127, 127, 100, 6, false, false);
+	driveSorted(-570, 520, 231, 127, 127, 100, 6, false);
 
 	drive(-550, 620, 284, 127, 100, 250, 10, false, false, false, true);
 
@@ -795,17 +1332,17 @@ void autonomous(){
 	feeder_middle.move(-conveyer_speed);
 	pros::delay(20);
 
-	drive(-510, 1840, 358, 127, 100, 70, 10, true, false);
-	drive(-510, 2240, 0, 127, 100, 70, 10, true, false);
+	driveSorted(-510, 1840, 358, 127, 100, 70, 10, true);
+	driveSorted(-510, 2240, 0, 127, 100, 70, 10, true);
 
-	drive(-440, 2555, 272, 120, 110, 30, 3, true, false);
-	drive(-1400, 2570, 272, 110, 40, 1, 3, true, false, true);
+	driveSorted(-440, 2555, 272, 120, 110, 30, 3, true);
+	driveSorted(-1400, 2570, 272, 110, 40, 1, 3, true, true);
 
 	scoreAndStore(2);
 
 	reverseIntakeOneThird();
 
-	drive(-480, 2580, 270, 127, 40, 70, 8, false, false);
+	driveSorted(-480, 2580, 270, 127, 40, 70, 8, false);
 
 	turnOnIntake();
 
@@ -819,19 +1356,19 @@ void autonomous(){
 
 	drive(-700, 4280, 273, 120, 120, 70, 6, false, true);
 
-	drive(-690, 4640, 313, 120, 120, 40, 4, true, false);
+	driveSorted(-690, 4640, 313, 120, 120, 40, 4, true);
 
-	drive(-1120, 5070, 313, 120, 40, 1, 5, true, false, true);
+	driveSorted(-1120, 5070, 313, 120, 40, 1, 5, true, true);
 
 	scoreAndStore(4);
 
 	reverseIntakeOneThird();
 
-	drive(-740, 4705, 316, 120, 127, 70, 5, false, false);
+	driveSorted(-740, 4705, 316, 120, 127, 70, 5, false);
 
 	turnOnIntake();
 
-	drive(-720, 4480, 325, 127, 100, 100, 5, false, false);
+	driveSorted(-720, 4480, 325, 127, 100, 100, 5, false);
 
 	drive(-800, 4450, 330, 127, 127, 150, 5, false, true);
 
@@ -839,13 +1376,14 @@ void autonomous(){
 
 	drive(-300, 4580, 89, 127, 127, 100, 3, false, true);
 
-	drive(-220, 2815, 91, 120, 100, 100, 2, true, false);
+	driveSorted(-220, 2815, 91, 120, 100, 100, 2, true);
 
-	drive(300, 2570, 91, 85, 85, 20, 2, true, false);
+	driveSorted(300, 2570, 91, 85, 85, 20, 2, true);
 
-	drive(1500, 2550, 92, 95, 95, 1, 2, true, false, true);
+	driveSorted(1500, 2550, 92, 95, 95, 1, 2, true, true);
 
-	scoreAndStore(3);
+	//The robot stays at the goal until the descored balls are counted through, the back-off poops the rest out
+	run(ScoreAction(3, true));
 
 	reverseIntakeHalf();
 
@@ -858,9 +1396,9 @@ void autonomous(){
 	drive(900, 3190, 60, 127, 127, 150, 8, false, true);
 	drive(1470, 3290, 57, 127, 127, 150, 8, false, true);
 
-	drive(1570, 4300, 1, 127, 100, 70, 6, true, false);
-	drive(1570, 4700, 1, 120, 120, 30, 3, true, false);
-	drive(1560, 4900, 1, 120, 40, 1, 5, true, false, true);
+	driveSorted(1570, 4300, 1, 127, 100, 70, 6, true);
+	driveSorted(1570, 4700, 1, 120, 120, 30, 3, true);
+	driveSorted(1560, 4900, 1, 120, 40, 1, 5, true, true);
 
 	scoreAndStore(5);
 
@@ -872,11 +1410,11 @@ void autonomous(){
 
 	drive(1910, 4200, 65, 127, 127, 100, 5, false, true);
 
-	drive(3280, 4300, 65, 127, 127, 80, 7, true, false);
+	driveSorted(3280, 4300, 65, 127, 127, 80, 7, true);
 
-	drive(3870, 4870, 43, 100, 100, 30, 3, true, false);
+	driveSorted(3870, 4870, 43, 100, 100, 30, 3, true);
 
-	drive(4000, 5000, 43, 120, 40, 1, 3, true, false, true);
+	driveSorted(4000, 5000, 43, 120, 40, 1, 3, true, true);
 
 	scoreAndStore(4);
 
@@ -895,11 +1433,11 @@ void autonomous(){
 	stopHold();
 	pros::delay(10);
 
-	drive(3580, 3235, 175, 127, 127, 100, 5, true, false);
-	drive(3580, 2835, 175, 127, 127, 80, 5, true, false);
-	drive(3500, 2615, 91, 120, 110, 30, 5, true, false);
+	driveSorted(3580, 3235, 175, 127, 127, 100, 5, true);
+	driveSorted(3580, 2835, 175, 127, 127, 80, 5, true);
+	driveSorted(3500, 2615, 91, 120, 110, 30, 5, true);
 
-	drive(4210, 2580, 91, 120, 40, 1, 5, true, false, true);
+	driveSorted(4210, 2580, 91, 120, 40, 1, 5, true, true);
 
 	scoreAndStore(2);
 
@@ -912,30 +1450,30 @@ void autonomous(){
 	drive(3420, 2510, 258, 127, 127, 200, 5, false, false, false, true);
 	drive(2830, 2500, 269, 127, 127, 200, 5, false, false, false, true);
 
-	drive(2280, 1630, 265, 127, 127, 100, 5, true, false);
-	drive(1745, 1630, 265, 127, 127, 80, 5, true, false);
+	driveSorted(2280, 1630, 265, 127, 127, 100, 5, true);
+	driveSorted(1745, 1630, 265, 127, 127, 80, 5, true);
 
-	drive(1610, 400, 182, 100, 100, 30, 3, true, false);
+	driveSorted(1610, 400, 182, 100, 100, 30, 3, true);
 
-	drive(1610, -300, 180, 120, 40, 1, 5, true, false, true);
+	driveSorted(1610, -300, 180, 120, 40, 1, 5, true, true);
 
 	scoreAndStore(2);
 
 	reverseIntakeOneThird();
 
-	drive(1630, 600, 180, 127, 127, 100, 3, false, false);
+	driveSorted(1630, 600, 180, 127, 127, 100, 3, false);
 
 	turnOnIntake();
 
 	drive(2450, 1070, 137, 127, 127, 100, 6, false, true);
 	drive(2910, 750, 137, 127, 127, 100, 6, false, true);
 
-	drive(3550, 945, 90, 127, 127, 100, 6, true, false);
-	drive(3875, 930, 90, 120, 120, 70, 6, true, false);
+	driveSorted(3550, 945, 90, 127, 127, 100, 6, true);
+	driveSorted(3875, 930, 90, 120, 120, 70, 6, true);
 	pros::delay(20);
 
-	drive(3740, 480, 137, 120, 120, 30, 2, true, false);
-	drive(4220, 0, 137, 110, 40, 1, 3, true, false, true);
+	driveSorted(3740, 480, 137, 120, 120, 30, 2, true);
+	driveSorted(4220, 0, 137, 110, 40, 1, 3, true, true);
 
 	scoreAndStore(1);
 
@@ -947,124 +1485,45 @@ void autonomous(){
 
 	drive(3720, 450, 133, 90, 90, 100, 6, false, true);
 
-	pros::lcd::set_text(5, std::to_string(pros::millis()-initial_time));
-	pros::lcd::set_text(6, "Completed");
+	screen.setLine(5, "%ld", (long)(pros::millis()-initial_time));
+	screen.setLine(6, "Completed");
+
+	reportJamStats();
+	health_monitor.report();
+	scheduler.report();
+	profileReport();
+	autonomous_running = false;
+	saveSegments();
+	flight_recorder.flush();
 
 	/**/
 
+	auto_sort = false;
 	stopCoast();
 	turnOffIntake();
 }
 
 
 void opcontrol() {
-	while (true) {
-
-		// Position tracking stuff
-		float curr_encoder_fwd_rev = (right_encoder.get_value() + left_encoder.get_value()) / 2;
-		float curr_encoder_left_right = center_encoder.get_value();
-
-		angle_ = inertial.get_heading();
-		if(angle_ > 360) angle_ = 0;
-		if(angle_ < 0) angle_ = angle_+360;
-		pos_x = pos_x - (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * -sin(angle_*PI/180)) + ((curr_encoder_left_right-prev_encoder_left_right) * -cos(angle_*PI/180)));
-		pos_y = pos_y + (((curr_encoder_fwd_rev-prev_encoder_fwd_rev) * cos(angle_*PI/180)) - ((curr_encoder_left_right-prev_encoder_left_right) * sin(angle_*PI/180)));
-		prev_encoder_fwd_rev = curr_encoder_fwd_rev;
-		prev_encoder_left_right = curr_encoder_left_right;
-
-		pros::lcd::set_text(1, std::to_string(pos_x));
-		pros::lcd::set_text(2, std::to_string(pos_y));
-
-
+	ControlRate rate (driver_loop_stats);
 
+	while (true) {
 		/*AWESOME DRIVE*/
-
-		//Getting raw joystick values
-    float up_down = master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
-  	float left_right = master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_X);
-		float turnX = master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
-		float turnY = master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
-
-		//Getting current angle
-		float angle = inertial.get_heading();
-		if(angle < 0) angle = 360 + angle;
-
-		//Calculating left joystick angle
-		float joystick_angle = atan(left_right/up_down) * 180 / PI;
-		if(up_down < 0) joystick_angle = 180 + joystick_angle;
-		if(joystick_angle < 0) joystick_angle = 360 + joystick_angle;
-
-		//Calcualating difference in angles
-		float difference = angle - joystick_angle;
-		if(difference < 0) difference = 360 + difference;
-		difference = 360 - difference;
-
-		//Magnitude calculations
-		float magnitude = sqrt(pow(up_down, 2.0) + pow(left_right, 2.0));
-		if(magnitude > 127) magnitude = 127;
-
-		//Calculating right joystick angle
-		float turn_angle = atan(turnX/turnY) * 180 / PI;
-		if(turnY < 0) turn_angle = 180 + turn_angle;
-		if(turn_angle < 0) turn_angle = 360 + turn_angle;
-
-		//Calculating turn difference in angles
-		float turn_difference = turn_angle - angle;
-		if(turn_difference < 0) turn_difference = 360 + turn_difference;
-		turn_difference = 360 - turn_difference;
-
-		//Turn magnitude calculations
-		float turn_magnitude = (sqrt(pow(turnY, 2.0) + pow(turnX, 2.0)))*((turn_difference/360)+0.5);
-		if(turn_magnitude > 127) turn_magnitude = 127;
-
-		//Calculating actual turn value based on joystick position
-		if(turn_difference < 180){
-			turn_magnitude = -turn_magnitude;}
-		if(turn_difference > 180) turn_difference = 360 - turn_difference;
-		float proportion = sqrt(turn_difference/60);
-		turn_magnitude = turn_magnitude*proportion;
-		if(isinf(turn_magnitude)) turn_magnitude = 0;
-		if(turn_difference < 1 || turn_difference > 359) turn_magnitude = 0;
-
-		//Actual calculated values for motors
-		int actual_up_down = cos(difference * PI / 180.0) * magnitude;
-		int actual_left_right = -sin(difference * PI / 180.0) * magnitude;
-		int actual_turn = turn_magnitude;
-
-		//Applying final values to motors for motion
-    left_wheel_front.move(actual_up_down - actual_left_right + actual_turn);
-		left_wheel_back.move(actual_up_down + actual_left_right + actual_turn);
-    right_wheel_front.move(-actual_up_down - actual_left_right + actual_turn);
-		right_wheel_back.move(-actual_up_down + actual_left_right + actual_turn);
-
-		//Intake subsytem controls
-		if(master.get_digital(pros::E_CONTROLLER_DIGITAL_R2)){
-			left_intake.move(intake_speed);
-			right_intake.move(-intake_speed);
+		PROFILE_START(input, "driver.input");
+
+		ControllerState input = readController();
+		float hold_heading = PROS_ERR_F;
+		macroButtons();
+		if(driver_macro.playing()) driver_macro.play(pros::millis(), latestSensors(), input, hold_heading);
+		if(driver_macro.recording() && driver_macro.record(input, latestSensors()) == false){
+			printf("[macro] recording full\n");
+			saveMacro();
 		}
-		else if(master.get_digital(pros::E_CONTROLLER_DIGITAL_R1)){
-			left_intake.move(-intake_speed);
-			right_intake.move(intake_speed);
-		}
-		else{
-			left_intake.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-			left_intake.move(0);
-			right_intake.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-			right_intake.move(0);}
-
-		pros::lcd::set_text(3, std::to_string(ball_limit_switch2.get_value()));
+		driverControl(input, hold_heading);
 
-		if(master.get_digital(pros::E_CONTROLLER_DIGITAL_L2)){
-			feeder_middle.move(-conveyer_speed);
-			feeder_top.move(-conveyer_speed);
-		}
-		else{
-			//Stops the conveyer and indexer if button is not clicked
-			feeder_middle.move(0);
-			feeder_top.move(0);
-		}
+		PROFILE_STOP(input);
 
-		//Saves resources
-    pros::delay(1);
+		//Fixed loop period
+		rate.wait();
   }
 }
@@ -0,0 +1,48 @@
+#include "monitor.hpp"
+#include "pros/rtos.hpp"
+#include <cstdio>
+
+RuntimeMonitor::RuntimeMonitor(const Scheduler& scheduler) : scheduler_(scheduler) {}
+
+float RuntimeMonitor::cpuShare(int index) const{
+	std::uint64_t elapsed = pros::micros() - scheduler_.startTime();
+	if(elapsed == 0) return 0;
+	return 100.0f * scheduler_.stats(index).run_time.total() / elapsed;
+}
+
+float RuntimeMonitor::totalCpuShare() const{
+	float total = 0;
+	for(int i = 0; i < scheduler_.count(); i++) total += cpuShare(i);
+	return total;
+}
+
+void RuntimeMonitor::printReport() const{
+	printf("[cpu] total %.2f%%, %lu tasks\n", totalCpuShare(), (unsigned long)pros::Task::get_count());
+
+	for(int i = 0; i < scheduler_.count(); i++){
+		const LoopStats& stats = scheduler_.stats(i);
+		const RunHistogram& run_time = stats.run_time;
+		if(run_time.count() == 0) continue;
+
+		printf("[cpu] %-9s min %5lu avg %5lu max %6lu p99 %6lu us, %5.2f%%, %lu overruns\n", stats.name,
+			(unsigned long)run_time.min(), (unsigned long)run_time.average(), (unsigned long)run_time.max(),
+			(unsigned long)run_time.percentile(99), cpuShare(i), (unsigned long)stats.overruns);
+	}
+}
+
+void RuntimeMonitor::updateScreen(Screen& screen){
+	screen.setLine(MONITOR_LCD_TOTAL_LINE, "CPU %.1f%%  tasks %lu", totalCpuShare(), (unsigned long)pros::Task::get_count());
+
+	//Next loop that has actually run
+	for(int tries = 0; tries < scheduler_.count(); tries++){
+		screen_cursor_ = (screen_cursor_ + 1) % scheduler_.count();
+		const LoopStats& stats = scheduler_.stats(screen_cursor_);
+		const RunHistogram& run_time = stats.run_time;
+		if(run_time.count() == 0) continue;
+
+		screen.setLine(MONITOR_LCD_LOOP_LINE, "%s %lu/%lu/%lu p99 %lu us %.1f%%", stats.name,
+			(unsigned long)run_time.min(), (unsigned long)run_time.average(), (unsigned long)run_time.max(),
+			(unsigned long)run_time.percentile(99), cpuShare(screen_cursor_));
+		break;
+	}
+}
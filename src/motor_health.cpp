@@ -0,0 +1,164 @@
+#include "motor_health.hpp"
+#include "pros/rtos.hpp"
+#include <cmath>
+#include <cstdio>
+
+/*=============
+** DERATED MOTOR
+=============*/
+DeratedMotor::DeratedMotor(const std::uint8_t port, const char* name) : pros::Motor(port), name_(name) {}
+
+std::int32_t DeratedMotor::move(std::int32_t voltage) const{
+	return pros::Motor::move(voltage * scale_.load(std::memory_order_relaxed));
+}
+
+std::int32_t DeratedMotor::move_voltage(const std::int32_t voltage) const{
+	return pros::Motor::move_voltage(voltage * scale_.load(std::memory_order_relaxed));
+}
+
+void DeratedMotor::setScale(float scale){
+	scale_.store(scale, std::memory_order_relaxed);
+}
+
+float DeratedMotor::scale() const{
+	return scale_.load(std::memory_order_relaxed);
+}
+
+const char* DeratedMotor::name() const{
+	return name_;
+}
+
+/*=============
+** HEALTH MONITOR
+=============*/
+bool MotorHealthMonitor::addGroup(const char* name, DeratedMotor* const* motors, int count){
+	if(group_count_ == HEALTH_MAX_GROUPS || motor_count_ + count > HEALTH_MAX_MOTORS) return false;
+
+	groups_[group_count_] = Group{name, motor_count_, count, 1};
+	group_count_ += 1;
+
+	for(int i = 0; i < count; i++){
+		motors_[motor_count_] = MotorHealth{motors[i], 0, 0, 0, 0, 0, 0, 0, false, 0, 0};
+		motor_count_ += 1;
+	}
+	return true;
+}
+
+void MotorHealthMonitor::update(){
+	std::uint32_t now = pros::millis();
+
+	for(int g = 0; g < group_count_; g++){
+		Group& group = groups_[g];
+
+		float target = 1;
+		for(int i = group.first; i < group.first + group.count; i++){
+			sample(motors_[i], now);
+			float scale = targetScale(motors_[i]);
+			if(scale < target) target = scale;
+		}
+
+		//Ramps toward the target so the driver (and the drive loops) never feel a step
+		float previous = group.scale;
+		if(target < group.scale) group.scale = fmaxf(target, group.scale - HEALTH_SCALE_DOWN_STEP);
+		else group.scale = fminf(target, group.scale + HEALTH_SCALE_UP_STEP);
+
+		for(int i = group.first; i < group.first + group.count; i++) motors_[i].motor->setScale(group.scale);
+
+		int previous_step = (int)ceilf(previous * 10 - 0.001f);
+		int step = (int)ceilf(group.scale * 10 - 0.001f);
+		if(step != previous_step) logEvent(now, group.name, HEALTH_DERATE, group.scale * 100);
+	}
+}
+
+void MotorHealthMonitor::sample(MotorHealth& health, std::uint32_t now){
+	DeratedMotor& motor = *health.motor;
+
+	//get_flags() returns PROS_ERR (INT32_MAX) when the port has no motor
+	std::uint32_t flags = motor.get_flags();
+	if(flags == INT32_MAX || (flags & pros::E_MOTOR_FLAGS_BUSY)){
+		if((health.flags & pros::E_MOTOR_FLAGS_BUSY) == 0) logEvent(now, motor.name(), HEALTH_UNREACHABLE, 0);
+		health.flags = pros::E_MOTOR_FLAGS_BUSY;
+		return;
+	}
+	health.flags = flags;
+
+	double temperature = motor.get_temperature();
+	std::int32_t current = motor.get_current_draw();
+	std::uint32_t faults = motor.get_faults();
+	bool over_temp = motor.is_over_temp() == 1;
+
+	//Heating rate from the time between 5 C steps, dropping off while the temperature holds still
+	if(health.last_step_time == 0){
+		health.last_step_temperature = temperature;
+		health.last_step_time = now;
+	}
+	else if(temperature != health.last_step_temperature){
+		double seconds = (now - health.last_step_time) / 1000.0;
+		health.heating_rate = (temperature - health.last_step_temperature) / seconds;
+		health.last_step_temperature = temperature;
+		health.last_step_time = now;
+	}
+	else if(health.heating_rate > 0){
+		double bound = HEALTH_TEMP_STEP_C / ((now - health.last_step_time) / 1000.0);
+		if(bound < health.heating_rate) health.heating_rate = bound;
+	}
+
+	if(temperature >= HEALTH_DERATE_START_C && health.temperature < HEALTH_DERATE_START_C){
+		logEvent(now, motor.name(), HEALTH_WARM, temperature);
+	}
+	if(over_temp && health.over_temp == false) logEvent(now, motor.name(), HEALTH_OVER_TEMP, temperature);
+	if((faults & ~health.faults) != 0) logEvent(now, motor.name(), HEALTH_FAULT, faults);
+
+	health.temperature = temperature;
+	health.current = current;
+	health.faults = faults;
+	health.over_temp = over_temp;
+	if(temperature > health.peak_temperature) health.peak_temperature = temperature;
+	if(current > health.peak_current) health.peak_current = current;
+}
+
+float MotorHealthMonitor::targetScale(const MotorHealth& health) const{
+	if(health.over_temp || (health.faults & pros::E_MOTOR_FAULT_MOTOR_OVER_TEMP)) return HEALTH_MIN_SCALE;
+
+	double rise = health.heating_rate > 0 ? health.heating_rate * HEALTH_LOOKAHEAD_S : 0;
+	if(rise > HEALTH_MAX_PREDICTED_RISE_C) rise = HEALTH_MAX_PREDICTED_RISE_C;
+	double predicted = health.temperature + rise;
+
+	if(predicted <= HEALTH_DERATE_START_C) return 1;
+	if(predicted >= HEALTH_LIMIT_C) return HEALTH_MIN_SCALE;
+	return 1 - (1 - HEALTH_MIN_SCALE) * (predicted - HEALTH_DERATE_START_C) / (HEALTH_LIMIT_C - HEALTH_DERATE_START_C);
+}
+
+void MotorHealthMonitor::logEvent(std::uint32_t time, const char* name, HealthEventType type, std::int32_t value){
+	static const char* const type_names[] = {"warm", "over temp", "fault", "unreachable", "derate"};
+	printf("[health] %lu ms %s %s %ld\n", (unsigned long)time, name, type_names[type], (long)value);
+
+	if(event_count_ == HEALTH_MAX_EVENTS){
+		events_lost_ += 1;
+		return;
+	}
+	events_[event_count_] = HealthEvent{time, name, type, value};
+	event_count_ += 1;
+}
+
+float MotorHealthMonitor::groupScale(int group) const{
+	return groups_[group].scale;
+}
+
+double MotorHealthMonitor::maxTemperature() const{
+	double hottest = 0;
+	for(int i = 0; i < motor_count_; i++){
+		if(motors_[i].temperature > hottest) hottest = motors_[i].temperature;
+	}
+	return hottest;
+}
+
+void MotorHealthMonitor::report() const{
+	for(int i = 0; i < motor_count_; i++){
+		const MotorHealth& health = motors_[i];
+		printf("[health] %-13s %4.0f C (peak %4.0f, %+.2f C/s), %5ld mA (peak %5ld), faults 0x%02lx, scale %.2f\n",
+			health.motor->name(), health.temperature, health.peak_temperature, health.heating_rate,
+			(long)health.current, (long)health.peak_current, (unsigned long)health.faults, health.motor->scale());
+	}
+	printf("[health] %d events logged, %d lost\n", event_count_, events_lost_);
+}
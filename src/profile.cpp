@@ -0,0 +1,45 @@
+#include "profile.hpp"
+
+#ifdef ENABLE_PROFILING
+
+#include <atomic>
+#include <cstdio>
+
+static ProfileSite* sites[PROFILE_MAX_SITES];
+static std::atomic<int> site_count {0};
+
+ProfileSite::ProfileSite(const char* name) : name(name) {
+	int index = site_count.fetch_add(1);
+	if(index < PROFILE_MAX_SITES) sites[index] = this;
+}
+
+void profileReport(){
+	int count = site_count.load();
+	if(count > PROFILE_MAX_SITES){
+		printf("[prof] %d sites, only the first %d are reported\n", count, PROFILE_MAX_SITES);
+		count = PROFILE_MAX_SITES;
+	}
+
+	for(int i = 0; i < count; i++){
+		//Registered but not stored yet
+		if(sites[i] == nullptr) continue;
+
+		const RunHistogram& run_time = sites[i]->run_time;
+		if(run_time.count() == 0) continue;
+
+		printf("[prof] %-14s %7lu runs, min %5lu avg %5lu max %6lu p99 %6lu us\n", sites[i]->name,
+			(unsigned long)run_time.count(), (unsigned long)run_time.min(), (unsigned long)run_time.average(),
+			(unsigned long)run_time.max(), (unsigned long)run_time.percentile(99));
+	}
+}
+
+void profileReset(){
+	int count = site_count.load();
+	if(count > PROFILE_MAX_SITES) count = PROFILE_MAX_SITES;
+
+	for(int i = 0; i < count; i++){
+		if(sites[i] != nullptr) sites[i]->run_time.reset();
+	}
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include "recorder.hpp"
+#include "pros/misc.hpp"
+#include <cstring>
+
+bool FlightRecorder::start(){
+	if(writer_ != nullptr) return true;
+	if(pros::usd::is_installed() == false) return false;
+
+	for(int i = 0; i < FLIGHT_RECORDER_MAX_FILES; i++){
+		snprintf(path_, sizeof(path_), SD_DIR "flight_%02d.bin", i);
+
+		std::FILE* existing = std::fopen(path_, "rb");
+		if(existing == nullptr) break;
+		std::fclose(existing);
+
+		//Every name is taken, keeps overwriting the last one
+		if(i == FLIGHT_RECORDER_MAX_FILES - 1) std::remove(path_);
+	}
+	printf("[rec] recording to %s\n", path_);
+
+	pros::Task task (writerTask, this, TASK_PRIORITY_MIN+1, TASK_STACK_DEPTH_DEFAULT, "recorder");
+	writer_ = task;
+	return true;
+}
+
+bool FlightRecorder::record(const TelemetryFrame& frame){
+	if(writer_ == nullptr) return false;
+
+	//Never waits, the sampling callback shares a task with other subsystems
+	if(mutex_.take(0) == false){
+		dropped_.fetch_add(1);
+		return false;
+	}
+
+	//Encoded on a copy, a dropped frame mustn't become the one the next delta is taken against
+	TelemetryEncoder encoder = encoder_;
+	std::uint8_t packet[TELEMETRY_MAX_PACKET_SIZE];
+	std::size_t size = encoder.encode(frame, packet);
+
+	bool stored = true;
+	if(used_ + size > FLIGHT_BUFFER_SIZE) stored = handOff();
+	if(stored){
+		std::memcpy(buffers_[fill_] + used_, packet, size);
+		used_ += size;
+		encoder_ = encoder;
+	}
+	else{
+		dropped_.fetch_add(1);
+	}
+
+	mutex_.give();
+	return stored;
+}
+
+bool FlightRecorder::handOff(){
+	//The writer hasn't finished with the other buffer yet
+	if(pending_.load() != -1) return false;
+
+	pending_size_ = used_;
+	pending_.store(fill_);
+	pros::c::task_notify(writer_);
+
+	fill_ ^= 1;
+	used_ = 0;
+	return true;
+}
+
+void FlightRecorder::flush(){
+	if(writer_ == nullptr) return;
+
+	std::uint32_t start = pros::millis();
+	bool handed_off = false;
+
+	//Waits for the writer to take the previous buffer before passing it the half full one
+	while(pros::millis() - start < FLIGHT_FLUSH_TIMEOUT_MS){
+		if(mutex_.take(10)){
+			handed_off = used_ == 0 || handOff();
+			if(handed_off){
+				close_requested_.store(true);
+				pros::c::task_notify(writer_);
+			}
+			mutex_.give();
+		}
+		if(handed_off) break;
+		pros::delay(5);
+	}
+
+	while(close_requested_.load() == true && pros::millis() - start < FLIGHT_FLUSH_TIMEOUT_MS){
+		pros::delay(5);
+	}
+	if(close_requested_.load() == true) printf("[rec] flush timed out\n");
+}
+
+std::uint32_t FlightRecorder::dropped() const{
+	return dropped_.load();
+}
+
+void FlightRecorder::writerTask(void* parameter){
+	FlightRecorder& recorder = *static_cast<FlightRecorder*>(parameter);
+
+	while(true){
+		pros::Task::notify_take(true, TIMEOUT_MAX);
+
+		int pending = recorder.pending_.load();
+		if(pending != -1){
+			if(recorder.file_ == nullptr) recorder.file_ = std::fopen(recorder.path_, "ab");
+			if(recorder.file_ != nullptr) std::fwrite(recorder.buffers_[pending], 1, recorder.pending_size_, recorder.file_);
+			recorder.pending_.store(-1);
+		}
+
+		if(recorder.close_requested_.load() == true){
+			if(recorder.file_ != nullptr){
+				std::fclose(recorder.file_);
+				recorder.file_ = nullptr;
+			}
+			recorder.close_requested_.store(false);
+		}
+	}
+}
@@ -0,0 +1,127 @@
+#include "scheduler.hpp"
+#include "pros/rtos.hpp"
+#include <cstdio>
+
+void recordRun(LoopStats& stats, std::uint64_t actual_period_us, std::uint64_t run_us){
+	stats.runs += 1;
+
+	if(actual_period_us > 0){
+		std::uint64_t ideal_us = stats.period_ms * 1000ULL;
+		std::uint64_t jitter = actual_period_us > ideal_us ? actual_period_us - ideal_us : ideal_us - actual_period_us;
+		stats.total_jitter_us += jitter;
+		if(jitter > stats.max_jitter_us) stats.max_jitter_us = jitter;
+	}
+
+	stats.run_time.add(run_us);
+	stats.last_run_us = run_us;
+	if(run_us > stats.period_ms * 1000ULL) stats.overruns += 1;
+}
+
+/*=============
+** CONTROL RATE
+=============*/
+ControlRate::ControlRate(LoopStats* stats) : stats_(stats) {
+	wake_ms_ = pros::millis();
+	start_us_ = pros::micros();
+}
+
+void ControlRate::wait(){
+	std::uint64_t run_us = pros::micros() - start_us_;
+	std::uint64_t previous_start_us = start_us_;
+
+	pros::Task::delay_until(&wake_ms_, stats_->period_ms);
+
+	start_us_ = pros::micros();
+	recordRun(*stats_, start_us_ - previous_start_us, run_us);
+}
+
+/*=============
+** SCHEDULER
+=============*/
+const LoopStats* Scheduler::add(const char* name, UpdateCallback callback, std::uint32_t period_ms, std::uint32_t priority){
+	if(started_ || callback_count_ == SCHEDULER_MAX_CALLBACKS || count_ == SCHEDULER_MAX_CALLBACKS + SCHEDULER_MAX_LOOPS) return nullptr;
+
+	//Finds the task this callback will run in
+	int group = -1;
+	for(int i = 0; i < group_count_; i++){
+		if(groups_[i].period_ms == period_ms && groups_[i].priority == priority) group = i;
+	}
+	if(group == -1){
+		if(group_count_ == SCHEDULER_MAX_GROUPS) return nullptr;
+		group = group_count_;
+		groups_[group] = Group{period_ms, priority, {}, 0, this};
+		group_count_ += 1;
+	}
+
+	entries_[count_] = Entry{callback, LoopStats{name, period_ms, 0, 0, 0, 0, RunHistogram()}};
+	groups_[group].callbacks[groups_[group].callback_count] = count_;
+	groups_[group].callback_count += 1;
+	count_ += 1;
+	callback_count_ += 1;
+	return &entries_[count_ - 1].stats;
+}
+
+LoopStats* Scheduler::addLoop(const char* name, std::uint32_t period_ms){
+	if(count_ == SCHEDULER_MAX_CALLBACKS + SCHEDULER_MAX_LOOPS) return nullptr;
+
+	entries_[count_] = Entry{nullptr, LoopStats{name, period_ms, 0, 0, 0, 0, RunHistogram()}};
+	count_ += 1;
+	return &entries_[count_ - 1].stats;
+}
+
+void Scheduler::start(){
+	if(started_) return;
+	started_ = true;
+	start_us_ = pros::micros();
+
+	for(int i = 0; i < group_count_; i++){
+		pros::Task task (groupTask, &groups_[i], groups_[i].priority, TASK_STACK_DEPTH_DEFAULT, entries_[groups_[i].callbacks[0]].stats.name);
+	}
+}
+
+void Scheduler::groupTask(void* parameter){
+	Group& group = *static_cast<Group*>(parameter);
+	Entry* entries = group.scheduler->entries_;
+
+	std::uint32_t wake_ms = pros::millis();
+	std::uint64_t previous_us[SCHEDULER_MAX_CALLBACKS] = {};
+
+	while(true){
+		for(int i = 0; i < group.callback_count; i++){
+			Entry& entry = entries[group.callbacks[i]];
+
+			std::uint64_t start_us = pros::micros();
+			entry.callback();
+			std::uint64_t end_us = pros::micros();
+
+			recordRun(entry.stats, previous_us[i] > 0 ? start_us - previous_us[i] : 0, end_us - start_us);
+			previous_us[i] = start_us;
+		}
+
+		pros::Task::delay_until(&wake_ms, group.period_ms);
+	}
+}
+
+std::uint64_t Scheduler::startTime() const{
+	return start_us_;
+}
+
+int Scheduler::count() const{
+	return count_;
+}
+
+const LoopStats& Scheduler::stats(int index) const{
+	return entries_[index].stats;
+}
+
+void Scheduler::report() const{
+	for(int i = 0; i < count_; i++){
+		const LoopStats& stats = entries_[i].stats;
+		if(stats.runs == 0) continue;
+
+		printf("[sched] %s @%lums: %lu runs, %lu overruns, jitter avg %lu max %lu us, run avg %lu max %lu us\n",
+			stats.name, (unsigned long)stats.period_ms, (unsigned long)stats.runs, (unsigned long)stats.overruns,
+			(unsigned long)(stats.total_jitter_us / stats.runs), (unsigned long)stats.max_jitter_us,
+			(unsigned long)stats.run_time.average(), (unsigned long)stats.run_time.max());
+	}
+}
@@ -0,0 +1,111 @@
+#include "scoring.hpp"
+
+ScoreInterpreter::ScoreInterpreter(const ScoreRecipe& recipe) : recipe_(recipe) {}
+
+ScoreOutput ScoreInterpreter::start(){
+	ScoreOutput output;
+	output.top_speed = recipe_.top_speed;
+	output.middle_speed = recipe_.middle_speed;
+	if(recipe_.creep_speed != 0) output.creep_speed = recipe_.creep_speed;
+	if(recipe_.intake.off_at_start) output.intake = SCORE_INTAKE_OFF;
+	return output;
+}
+
+ScoreOutput ScoreInterpreter::step(const ScoreInput& input){
+	ScoreOutput output;
+	const long t = input.elapsed;
+
+	//Middle roller indexing
+	if(recipe_.index.enabled){
+		const ScoreIndex& index = recipe_.index;
+
+		if(input.ball_sensor2 > SCORE_SENSOR2_ENTER && phase1_ == false){
+			phase1_ = true;
+		}
+		if(phase1_ == true && input.ball_sensor2 < SCORE_SENSOR2_LEAVE && phase2_ == false && t > index.phase2_after){
+			phase2_ = true;
+			phase2_time_ = t;
+			if(index.slow_phase == 2 && holding_ == false) output.middle_speed = index.slow_speed;
+		}
+		if(phase2_ == true && input.ball_sensor > SCORE_SENSOR1_ENTER && phase3_ == false){
+			phase3_ = true;
+			if(index.slow_phase == 3 && holding_ == false) output.middle_speed = index.slow_speed;
+		}
+		if(phase2_ == true && input.ball_sensor2 > SCORE_SENSOR2_LEAVE && holding_ == false && t > index.hold_after){
+			output.hold_middle = true;
+			output.middle_speed = 0;
+			hold_position_ = input.middle_position + index.hold_offset;
+			holding_ = true;
+		}
+
+		//Keeps the stored ball locked in place until the eject starts
+		bool ejecting = recipe_.eject.eject_after != SCORE_NEVER && phase2_ == true && t - phase2_time_ > recipe_.eject.eject_after;
+		bool hold_window = recipe_.eject.eject_after == SCORE_NEVER || (phase2_ == true && t - phase2_time_ < recipe_.eject.eject_after);
+		if(holding_ == true && hold_window){
+			if(input.middle_position < hold_position_){
+				output.middle_speed = index.hold_speed;
+			}
+			else{
+				output.middle_speed = -index.hold_speed;
+			}
+		}
+		else if(ejecting){
+			output.middle_speed = -127;
+			output.top_speed = 127;
+		}
+	}
+
+	//Counting balls that pass the second sensor
+	const ScoreEject& eject = recipe_.eject;
+	if(eject.count_target > 0 && phase2_ == true && phase3_ == true && t - phase2_time_ > eject.count_after){
+		if(input.ball_sensor2 > SCORE_SENSOR2_COUNT && engaged_ == false){
+			engaged_ = true;
+			count_ += 1;
+			if(count_ == eject.count_target) counted_time_ = t;
+		}
+		else if(input.ball_sensor2 < SCORE_SENSOR2_COUNT && engaged_ == true){
+			engaged_ = false;
+		}
+	}
+
+	//Stopping the conveyer on the second sensor
+	const ScoreStop& stop = recipe_.stop;
+	if(stop.enabled && stopped_ == false && input.ball_sensor2 > SCORE_SENSOR2_COUNT && t > stop.stop_after){
+		output.hold_middle = true;
+		output.middle_speed = 0;
+		stopped_ = true;
+		stopped_time_ = t;
+	}
+	if(stopped_ == true && top_stopped_ == false && t - stopped_time_ >= stop.top_delay){
+		output.hold_top = true;
+		output.top_speed = 0;
+		top_stopped_ = true;
+	}
+
+	//Intake timing
+	const ScoreIntake& intake = recipe_.intake;
+	if(intake.on_from != SCORE_NEVER && t > intake.on_from && t < intake.on_until){
+		output.intake = SCORE_INTAKE_ON;
+	}
+	else if(intake.off_after != SCORE_NEVER && t > intake.off_after){
+		output.intake = SCORE_INTAKE_OFF;
+	}
+
+	//Exit conditions
+	if(eject.count_target > 0 && count_ >= eject.count_target && t - counted_time_ > eject.count_settle){
+		done_ = true;
+	}
+	else if(t > recipe_.timeout && (stopped_ == false || top_stopped_ == true)){
+		done_ = true;
+	}
+
+	return output;
+}
+
+bool ScoreInterpreter::done() const{
+	return done_;
+}
+
+bool ScoreInterpreter::counted() const{
+	return recipe_.eject.count_target > 0 && count_ >= recipe_.eject.count_target;
+}
@@ -0,0 +1,97 @@
+#include "screen.hpp"
+#include "pros/llemu.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+Screen::Screen(pros::Controller& controller) : controller_(controller) {}
+
+void Screen::setLine(int line, const char* format, ...){
+	if(line < 0 || line >= SCREEN_LINES) return;
+
+	char text[SCREEN_LINE_LENGTH];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+
+	mutex_.take(TIMEOUT_MAX);
+	std::memcpy(lines_[line], text, sizeof(text));
+	mutex_.give();
+}
+
+void Screen::setControllerLine(int line, const char* format, ...){
+	if(line < 0 || line >= CONTROLLER_LINES) return;
+
+	//Padded to the full width so a shorter message covers the previous one
+	char text[CONTROLLER_LINE_LENGTH + 1];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+	if(length < 0) length = 0;
+	for(int i = length; i < CONTROLLER_LINE_LENGTH; i++) text[i] = ' ';
+	text[CONTROLLER_LINE_LENGTH] = '\0';
+
+	mutex_.take(TIMEOUT_MAX);
+	std::memcpy(controller_lines_[line], text, sizeof(text));
+	mutex_.give();
+}
+
+void Screen::rumble(const char* pattern){
+	mutex_.take(TIMEOUT_MAX);
+	std::strncpy(rumble_, pattern, CONTROLLER_RUMBLE_LENGTH);
+	rumble_[CONTROLLER_RUMBLE_LENGTH] = '\0';
+	mutex_.give();
+}
+
+void Screen::update(){
+	char text[SCREEN_LINE_LENGTH];
+
+	for(int line = 0; line < SCREEN_LINES; line++){
+		mutex_.take(TIMEOUT_MAX);
+		bool changed = std::strcmp(lines_[line], drawn_lines_[line]) != 0;
+		if(changed) std::memcpy(text, lines_[line], sizeof(text));
+		mutex_.give();
+
+		if(changed && pros::c::lcd_set_text(line, text)) std::memcpy(drawn_lines_[line], text, sizeof(text));
+	}
+
+	if(pros::millis() - last_message_time_ >= CONTROLLER_MESSAGE_MS){
+		if(updateController()) last_message_time_ = pros::millis();
+	}
+}
+
+//Sends one rumble or changed line, true if something was sent
+bool Screen::updateController(){
+	char pattern[CONTROLLER_RUMBLE_LENGTH + 1];
+	char text[CONTROLLER_LINE_LENGTH + 1];
+
+	mutex_.take(TIMEOUT_MAX);
+	std::memcpy(pattern, rumble_, sizeof(pattern));
+	rumble_[0] = '\0';
+	mutex_.give();
+
+	if(pattern[0] != '\0'){
+		controller_.rumble(pattern);
+		return true;
+	}
+
+	//Round robin so one busy line can't starve the others
+	for(int tries = 0; tries < CONTROLLER_LINES; tries++){
+		int line = controller_cursor_;
+		controller_cursor_ = (controller_cursor_ + 1) % CONTROLLER_LINES;
+
+		mutex_.take(TIMEOUT_MAX);
+		bool changed = std::strcmp(controller_lines_[line], drawn_controller_lines_[line]) != 0;
+		if(changed) std::memcpy(text, controller_lines_[line], sizeof(text));
+		mutex_.give();
+
+		if(changed == false) continue;
+
+		//A failed send (controller busy or unplugged) leaves the line changed, so it's retried next slot
+		if(controller_.set_text(line, 0, text) == 1) std::memcpy(drawn_controller_lines_[line], text, sizeof(text));
+		return true;
+	}
+	return false;
+}
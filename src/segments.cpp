@@ -0,0 +1,65 @@
+#include "segments.hpp"
+#include <cmath>
+
+const char* const SEGMENT_EXIT_NAMES[] = {"reached", "goal_sensor", "done", "cancelled", "skipped"};
+
+void SegmentLog::reset(std::uint32_t now){
+	count_ = 0;
+	start_ms_ = now;
+	overflowed_ = false;
+}
+
+int SegmentLog::begin(const char* kind, std::uint32_t now, float goal_x, float goal_y, float goal_heading){
+	if(count_ == SEGMENT_MAX){
+		//Once per run, the rest of the route just goes unlogged
+		if(overflowed_ == false) printf("[segments] log full at %d segments, the rest of the run isn't logged\n", SEGMENT_MAX);
+		overflowed_ = true;
+		return -1;
+	}
+
+	segments_[count_] = Segment{kind, now - start_ms_, now - start_ms_, SEGMENT_CANCELLED, goal_x, goal_y, goal_heading, 0, 0};
+	count_ += 1;
+	return count_ - 1;
+}
+
+void SegmentLog::end(int index, std::uint32_t now, SegmentExit exit, float pos_x, float pos_y, float heading){
+	if(index < 0 || index >= count_) return;
+
+	Segment& segment = segments_[index];
+	segment.end_ms = now - start_ms_;
+	segment.exit = exit;
+	segment.position_error = sqrtf((segment.goal_x-pos_x)*(segment.goal_x-pos_x) + (segment.goal_y-pos_y)*(segment.goal_y-pos_y));
+
+	float heading_error = fabsf(heading - segment.goal_heading);
+	if(heading_error > 180) heading_error = 360 - heading_error;
+	segment.heading_error = heading_error;
+}
+
+int SegmentLog::count() const{
+	return count_;
+}
+
+const Segment& SegmentLog::segment(int index) const{
+	return segments_[index];
+}
+
+void SegmentLog::writeCsv(std::FILE* file, const char* prefix) const{
+	fprintf(file, "%s" SEGMENT_CSV_HEADER "\n", prefix);
+
+	for(int i = 0; i < count_; i++){
+		const Segment& segment = segments_[i];
+		fprintf(file, "%s%d,%s,%lu,%lu,%lu,%s,%.0f,%.0f,%.0f,%.1f,%.1f\n", prefix, i, segment.kind,
+			(unsigned long)segment.start_ms, (unsigned long)segment.end_ms, (unsigned long)(segment.end_ms - segment.start_ms),
+			SEGMENT_EXIT_NAMES[segment.exit], segment.goal_x, segment.goal_y, segment.goal_heading,
+			segment.position_error, segment.heading_error);
+	}
+}
+
+bool SegmentLog::saveCsv(const char* path) const{
+	std::FILE* file = std::fopen(path, "w");
+	if(file == nullptr) return false;
+
+	writeCsv(file, "");
+	std::fclose(file);
+	return true;
+}
@@ -0,0 +1,44 @@
+#include "telemetry.hpp"
+#include "pros/apix.h"
+#include <cstdio>
+
+void TelemetryStream::start(){
+	if(started_) return;
+	started_ = true;
+
+	pros::c::serctl(SERCTL_DISABLE_COBS, nullptr);
+	pros::Task task (writerTask, this, TASK_PRIORITY_MIN+1, TASK_STACK_DEPTH_DEFAULT, "telemetry");
+}
+
+bool TelemetryStream::record(const TelemetryFrame& frame){
+	return frames_.push(frame);
+}
+
+std::uint32_t TelemetryStream::dropped() const{
+	return frames_.dropped();
+}
+
+void TelemetryStream::writerTask(void* parameter){
+	TelemetryStream& stream = *static_cast<TelemetryStream*>(parameter);
+
+	//Leading 0 so whatever was on the line before (a half printed line) ends up in its own packet
+	static std::uint8_t buffer[1 + TELEMETRY_BATCH_FRAMES * TELEMETRY_MAX_PACKET_SIZE];
+	TelemetryFrame frame;
+	std::uint32_t wake_ms = pros::millis();
+
+	while(true){
+		std::size_t size = 0;
+		buffer[size++] = 0;
+
+		for(int batched = 0; batched < TELEMETRY_BATCH_FRAMES && stream.frames_.pop(frame); batched++){
+			size += stream.encoder_.encode(frame, buffer + size);
+		}
+
+		if(size > 1){
+			fwrite(buffer, 1, size, stdout);
+			fflush(stdout);
+		}
+
+		pros::Task::delay_until(&wake_ms, TELEMETRY_WRITE_PERIOD_MS);
+	}
+}
@@ -0,0 +1,160 @@
+#include "telemetry_codec.hpp"
+
+const char* const TELEMETRY_FIELD_NAMES[TLM_FIELD_COUNT] = {
+	"time", "pos_x", "pos_y", "heading",
+	"left_encoder", "right_encoder", "center_encoder",
+	"top_position", "middle_position",
+	"ball_sensor", "ball_sensor2", "goal_sensor",
+	"left_front_mv", "left_back_mv", "right_front_mv", "right_back_mv",
+	"feeder_top_mv", "feeder_middle_mv", "left_intake_mv", "right_intake_mv",
+	"sensors_run_us", "actions_run_us", "drivetrain_run_us",
+	"drive_scale", "max_temperature",
+};
+
+#define TELEMETRY_KEY_FLAG 0x80
+#define TELEMETRY_SEQUENCE_MASK 0x7F
+
+//CRC-8 (polynomial 0x07), catches the printf text and torn packets that end up between two delimiters
+static std::uint8_t checksum(const std::uint8_t* data, std::size_t size){
+	std::uint8_t crc = 0;
+	for(std::size_t i = 0; i < size; i++){
+		crc ^= data[i];
+		for(int bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+	return crc;
+}
+
+//Zigzag maps small negative and positive numbers to small unsigned ones (0, -1, 1, -2 -> 0, 1, 2, 3)
+static std::size_t putVarint(std::int32_t value, std::uint8_t* out){
+	std::uint32_t zigzag = ((std::uint32_t)value << 1) ^ (std::uint32_t)(value >> 31);
+	std::size_t size = 0;
+
+	while(zigzag >= 0x80){
+		out[size++] = (zigzag & 0x7F) | 0x80;
+		zigzag >>= 7;
+	}
+	out[size++] = zigzag;
+	return size;
+}
+
+//Returns the bytes used, or 0 if the varint runs past the end
+static std::size_t getVarint(const std::uint8_t* data, std::size_t size, std::int32_t& value){
+	std::uint32_t zigzag = 0;
+
+	for(std::size_t i = 0; i < size && i < 5; i++){
+		zigzag |= (std::uint32_t)(data[i] & 0x7F) << (7 * i);
+		if((data[i] & 0x80) == 0){
+			value = (std::int32_t)((zigzag >> 1) ^ -(zigzag & 1));
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+/*=============
+** COBS
+=============*/
+std::size_t cobsEncode(const std::uint8_t* data, std::size_t size, std::uint8_t* out){
+	std::size_t code_index = 0;
+	std::size_t out_size = 1;
+	std::uint8_t code = 1;
+
+	for(std::size_t i = 0; i < size; i++){
+		if(data[i] != 0){
+			out[out_size++] = data[i];
+			code += 1;
+		}
+
+		if(data[i] == 0 || code == 0xFF){
+			out[code_index] = code;
+			code_index = out_size++;
+			code = 1;
+		}
+	}
+
+	out[code_index] = code;
+	return out_size;
+}
+
+std::size_t cobsDecode(const std::uint8_t* data, std::size_t size, std::uint8_t* out){
+	std::size_t out_size = 0;
+	std::size_t i = 0;
+
+	while(i < size){
+		std::uint8_t code = data[i++];
+		if(code == 0 || i + code - 1 > size) return 0;
+
+		for(int j = 1; j < code; j++){
+			if(data[i] == 0) return 0;
+			out[out_size++] = data[i++];
+		}
+		if(code != 0xFF && i < size) out[out_size++] = 0;
+	}
+	return out_size;
+}
+
+/*=============
+** ENCODER
+=============*/
+std::size_t TelemetryEncoder::encode(const TelemetryFrame& frame, std::uint8_t out[TELEMETRY_MAX_PACKET_SIZE]){
+	std::uint8_t raw[TELEMETRY_MAX_RAW_SIZE];
+	bool key = since_key_ >= TELEMETRY_KEYFRAME_EVERY;
+
+	std::size_t size = 0;
+	raw[size++] = (key ? TELEMETRY_KEY_FLAG : 0) | (sequence_ & TELEMETRY_SEQUENCE_MASK);
+	for(int i = 0; i < TLM_FIELD_COUNT; i++){
+		std::int32_t value = key ? frame.values[i] : frame.values[i] - previous_.values[i];
+		size += putVarint(value, raw + size);
+	}
+	raw[size] = checksum(raw, size);
+	size += 1;
+
+	previous_ = frame;
+	sequence_ += 1;
+	since_key_ = key ? 1 : since_key_ + 1;
+
+	std::size_t packet_size = cobsEncode(raw, size, out);
+	out[packet_size++] = 0;
+	return packet_size;
+}
+
+/*=============
+** DECODER
+=============*/
+bool TelemetryDecoder::decode(const std::uint8_t* packet, std::size_t size, TelemetryFrame& frame){
+	if(size > TELEMETRY_MAX_PACKET_SIZE) return false;
+
+	std::uint8_t raw[TELEMETRY_MAX_PACKET_SIZE];
+	std::size_t raw_size = cobsDecode(packet, size, raw);
+	if(raw_size < 2 || checksum(raw, raw_size - 1) != raw[raw_size - 1]) return false;
+
+	bool key = raw[0] & TELEMETRY_KEY_FLAG;
+	std::uint8_t sequence = raw[0] & TELEMETRY_SEQUENCE_MASK;
+
+	TelemetryFrame decoded;
+	std::size_t offset = 1;
+	for(int i = 0; i < TLM_FIELD_COUNT; i++){
+		std::int32_t value;
+		std::size_t used = getVarint(raw + offset, raw_size - 1 - offset, value);
+		if(used == 0) return false;
+		offset += used;
+		decoded.values[i] = key ? value : previous_.values[i] + value;
+	}
+	if(offset != raw_size - 1) return false;
+
+	if(synced_ && sequence != sequence_){
+		missed_ += (sequence - sequence_) & TELEMETRY_SEQUENCE_MASK;
+		synced_ = false;
+	}
+	if(synced_ == false && key == false) return false;
+
+	previous_ = decoded;
+	sequence_ = (sequence + 1) & TELEMETRY_SEQUENCE_MASK;
+	synced_ = true;
+	frame = decoded;
+	return true;
+}
+
+std::uint32_t TelemetryDecoder::missed() const{
+	return missed_;
+}
@@ -0,0 +1,134 @@
+/*Replays vision frames through BallSorter and checks its store/eject decisions (make test).
+
+	ball_sort_test [frames.csv]
+
+	Feeds every frame of the file (default tools/ball_sort_frames.csv, format described at its top) to a
+	BallSorter in order, empty frames included, and after each frame runs the queue and pop checks listed for
+	it. Prints every check that fails with its line number and exits with 1 if any did.*/
+
+#include "ball_sort.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct FrameObject{
+	int frame;
+	bool ours;
+	pros::vision_object_s_t object;
+};
+
+struct Check{
+	int line;
+	int frame;
+	bool pop;                //pop one decision, or compare the whole queue
+	std::string expected;    //S, E and - as in the file
+};
+
+static char decisionLetter(BallDecision decision){
+	if(decision == BALL_STORE) return 'S';
+	if(decision == BALL_EJECT) return 'E';
+	return '-';
+}
+
+static bool readFrames(const char* path, std::vector<FrameObject>& objects, std::vector<Check>& checks){
+	std::FILE* file = std::fopen(path, "r");
+	if(file == nullptr){
+		perror(path);
+		return false;
+	}
+
+	char line[256];
+	int number = 0;
+	bool ok = true;
+	while(std::fgets(line, sizeof(line), file)){
+		number += 1;
+		if(line[0] == '#' || line[0] == '\n') continue;
+
+		FrameObject entry;
+		char color[16];
+		char expected[32];
+		int x, y, width, height;
+		if(std::sscanf(line, "object,%d,%15[^,],%d,%d,%d,%d", &entry.frame, color, &x, &y, &width, &height) == 6){
+			entry.ours = std::strcmp(color, "ours") == 0;
+			entry.object = pros::vision_object_s_t {};
+			entry.object.signature = entry.ours ? 1 : 2;
+			entry.object.x_middle_coord = x;
+			entry.object.y_middle_coord = y;
+			entry.object.left_coord = x - width / 2;
+			entry.object.top_coord = y - height / 2;
+			entry.object.width = width;
+			entry.object.height = height;
+			objects.push_back(entry);
+		}
+		else if(std::sscanf(line, "queue,%d,%31[SE-]", &entry.frame, expected) == 2){
+			checks.push_back({number, entry.frame, false, expected});
+		}
+		else if(std::sscanf(line, "pop,%d,%31[SE-]", &entry.frame, expected) == 2){
+			checks.push_back({number, entry.frame, true, expected});
+		}
+		else{
+			fprintf(stderr, "%s:%d: can't read this line\n", path, number);
+			ok = false;
+		}
+	}
+
+	std::fclose(file);
+	return ok;
+}
+
+int main(int argc, char** argv){
+	if(argc > 2){
+		fprintf(stderr, "usage: %s [frames.csv]\n", argv[0]);
+		return 1;
+	}
+	const char* path = argc == 2 ? argv[1] : "tools/ball_sort_frames.csv";
+
+	std::vector<FrameObject> objects;
+	std::vector<Check> checks;
+	if(readFrames(path, objects, checks) == false) return 1;
+
+	int last_frame = 0;
+	for(const FrameObject& entry : objects) last_frame = std::max(last_frame, entry.frame);
+	for(const Check& check : checks) last_frame = std::max(last_frame, check.frame);
+
+	BallSorter sorter;
+	int failures = 0;
+	for(int frame = 0; frame <= last_frame; frame++){
+		pros::vision_object_s_t ours[VISION_MAX_OBJECTS];
+		pros::vision_object_s_t theirs[VISION_MAX_OBJECTS];
+		int our_count = 0;
+		int their_count = 0;
+		for(const FrameObject& entry : objects){
+			if(entry.frame != frame) continue;
+			if(entry.ours && our_count < VISION_MAX_OBJECTS) ours[our_count++] = entry.object;
+			if(entry.ours == false && their_count < VISION_MAX_OBJECTS) theirs[their_count++] = entry.object;
+		}
+		sorter.update(ours, our_count, theirs, their_count);
+
+		for(const Check& check : checks){
+			if(check.frame != frame) continue;
+
+			std::string actual;
+			if(check.pop){
+				actual = decisionLetter(sorter.pop());
+			}
+			else{
+				//Pops a copy so the real queue is left alone
+				BallSorter copy = sorter;
+				while(copy.pending() > 0) actual += decisionLetter(copy.pop());
+				if(actual.empty()) actual = "-";
+			}
+
+			if(actual != check.expected){
+				printf("%s:%d: frame %d %s %s, expected %s\n", path, check.line, frame, check.pop ? "popped" : "queue", actual.c_str(),
+					check.expected.c_str());
+				failures += 1;
+			}
+		}
+	}
+
+	printf("%zu checks over %d frames, %d failed\n", checks.size(), last_frame + 1, failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,372 @@
+/*Microbenchmarks for the math the control loops run every tick (make bench).
+
+	bench [name]
+
+	Times the functions in include/drive_math.hpp and the okapi median filter on the computer, over a fixed
+	set of pseudo random inputs so every run sees the same branches. Each benchmark is scaled to run for at
+	least BENCH_MIN_MS, repeated BENCH_REPEATS times and the median reported in nanoseconds per call, with
+	the number of heap allocations per call. Only benchmarks whose name contains [name] run.
+
+	The numbers are for the host's CPU, not the brain's Cortex-A9, so compare runs against each other rather
+	than against the 5 ms budget of the control and odometry loops (CONTROL_PERIOD_MS, ODOMETRY_PERIOD_MS).
+
+	Before timing anything it checks the left stick half of driver.field_centric against the angle based
+	transform it replaced (driver.field_centric_old) and exits with 1 if they disagree. The right stick half
+	isn't compared, HeadingHold replaced the old turn on purpose.*/
+
+#include "drive_math.hpp"
+#include "okapi/api/filter/medianFilter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#define BENCH_MIN_MS 50
+#define BENCH_REPEATS 5
+#define BENCH_INPUTS 1024
+
+//okapilib isn't built for the host, the filter base class only needs its destructor
+okapi::Filter::~Filter() {}
+
+/*=============
+** ALLOCATION COUNTING
+=============*/
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size){
+	allocations += 1;
+	void* memory = std::malloc(size != 0 ? size : 1);
+	if(memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t size){
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept{
+	std::free(memory);
+}
+
+/*=============
+** INPUTS
+=============*/
+struct Inputs{
+	//Tracking wheels
+	std::int32_t left_encoder[BENCH_INPUTS];
+	std::int32_t right_encoder[BENCH_INPUTS];
+	std::int32_t center_encoder[BENCH_INPUTS];
+	float heading[BENCH_INPUTS];
+	float gyro_rate[BENCH_INPUTS];
+
+	//Drive targets
+	float goal_x[BENCH_INPUTS];
+	float goal_y[BENCH_INPUTS];
+	float pos_x[BENCH_INPUTS];
+	float pos_y[BENCH_INPUTS];
+	float goal_heading[BENCH_INPUTS];
+
+	//Joysticks
+	std::int32_t up_down[BENCH_INPUTS];
+	std::int32_t left_right[BENCH_INPUTS];
+	std::int32_t turnX[BENCH_INPUTS];
+	std::int32_t turnY[BENCH_INPUTS];
+
+	//Sensor readings
+	double reading[BENCH_INPUTS];
+};
+
+static Inputs inputs;
+
+static std::uint32_t random_state = 5327;
+
+static std::uint32_t nextRandom(){
+	random_state = random_state * 1664525 + 1013904223;
+	return random_state >> 8;
+}
+
+static float randomRange(float low, float high){
+	return low + (high - low) * (nextRandom() / 16777216.0f);
+}
+
+static void makeInputs(){
+	std::int32_t fwd_rev = 0;
+	std::int32_t left_right = 0;
+	for(int i = 0; i < BENCH_INPUTS; i++){
+		//Up to a few ticks per 5 ms odometry update, like the robot at speed
+		fwd_rev += randomRange(-1, 15);
+		left_right += randomRange(-2.5, 2.5);
+		inputs.left_encoder[i] = fwd_rev + randomRange(-2, 2);
+		inputs.right_encoder[i] = fwd_rev;
+		inputs.center_encoder[i] = left_right;
+		inputs.heading[i] = randomRange(0, 360);
+		inputs.gyro_rate[i] = randomRange(-300, 300);
+
+		inputs.goal_x[i] = randomRange(-1500, 4000);
+		inputs.goal_y[i] = randomRange(-1500, 4000);
+		inputs.pos_x[i] = randomRange(-1500, 4000);
+		inputs.pos_y[i] = randomRange(-1500, 4000);
+		inputs.goal_heading[i] = randomRange(0, 360);
+
+		//Whole numbers like get_analog(), a quarter of them with the sticks centred
+		bool centred = nextRandom() % 4 == 0;
+		inputs.up_down[i] = centred ? 0 : (int)randomRange(-127, 127);
+		inputs.left_right[i] = centred ? 0 : (int)randomRange(-127, 127);
+		inputs.turnX[i] = centred ? 0 : (int)randomRange(-127, 127);
+		inputs.turnY[i] = centred ? 0 : (int)randomRange(-127, 127);
+
+		inputs.reading[i] = randomRange(0, 4095);
+	}
+}
+
+/*=============
+** OLD FIELD-CENTRIC TRANSFORM
+=============*/
+/*The driver control math as it was before the vector version, kept as the reference. The brain's VFP turns a
+	NaN into 0 when converting to int (a centred stick makes atan() return one), x86 doesn't, so the conversions
+	go through brainInt() to give what the robot did.*/
+
+static int brainInt(float value){
+	if(std::isnan(value)) return 0;
+	if(value >= 2147483647.0f) return 2147483647;
+	if(value <= -2147483648.0f) return -2147483647 - 1;
+	return (int)value;
+}
+
+static WheelCommands oldFieldCentricDrive(float up_down, float left_right, float turnX, float turnY, float heading){
+	//Getting current angle
+	float angle = heading;
+	if(angle < 0) angle = 360 + angle;
+
+	//Calculating left joystick angle
+	float joystick_angle = atan(left_right/up_down) * 180 / PI;
+	if(up_down < 0) joystick_angle = 180 + joystick_angle;
+	if(joystick_angle < 0) joystick_angle = 360 + joystick_angle;
+
+	//Calcualating difference in angles
+	float difference = angle - joystick_angle;
+	if(difference < 0) difference = 360 + difference;
+	difference = 360 - difference;
+
+	//Magnitude calculations
+	float magnitude = sqrt(pow(up_down, 2.0) + pow(left_right, 2.0));
+	if(magnitude > 127) magnitude = 127;
+
+	//Calculating right joystick angle
+	float turn_angle = atan(turnX/turnY) * 180 / PI;
+	if(turnY < 0) turn_angle = 180 + turn_angle;
+	if(turn_angle < 0) turn_angle = 360 + turn_angle;
+
+	//Calculating turn difference in angles
+	float turn_difference = turn_angle - angle;
+	if(turn_difference < 0) turn_difference = 360 + turn_difference;
+	turn_difference = 360 - turn_difference;
+
+	//Turn magnitude calculations
+	float turn_magnitude = (sqrt(pow(turnY, 2.0) + pow(turnX, 2.0)))*((turn_difference/360)+0.5);
+	if(turn_magnitude > 127) turn_magnitude = 127;
+
+	//Calculating actual turn value based on joystick position
+	if(turn_difference < 180){
+		turn_magnitude = -turn_magnitude;}
+	if(turn_difference > 180) turn_difference = 360 - turn_difference;
+	float proportion = sqrt(turn_difference/60);
+	turn_magnitude = turn_magnitude*proportion;
+	if(std::isinf(turn_magnitude)) turn_magnitude = 0;
+	if(turn_difference < 1 || turn_difference > 359) turn_magnitude = 0;
+
+	//Actual calculated values for motors
+	int actual_up_down = brainInt(cos(difference * PI / 180.0) * magnitude);
+	int actual_left_right = brainInt(-sin(difference * PI / 180.0) * magnitude);
+	int actual_turn = brainInt(turn_magnitude);
+
+	WheelCommands commands;
+	commands.left_front = actual_up_down - actual_left_right + actual_turn;
+	commands.left_back = actual_up_down + actual_left_right + actual_turn;
+	commands.right_front = -actual_up_down - actual_left_right + actual_turn;
+	commands.right_back = -actual_up_down + actual_left_right + actual_turn;
+	return commands;
+}
+
+/*=============
+** EQUIVALENCE
+=============*/
+#define CHECK_INPUTS 2000000
+//Float rounding can put a value either side of a whole number before it is truncated
+#define CHECK_TOLERANCE 1
+
+//Random left stick positions and headings with the right stick centred, without deadband or shaping
+static bool checkFieldCentric(){
+	StickCurve linear;
+	int worst = 0;
+	long mismatches = 0;
+	for(long i = 0; i < CHECK_INPUTS; i++){
+		std::int32_t up_down = nextRandom() % 255 - 127;
+		std::int32_t left_right = nextRandom() % 255 - 127;
+		//A centred stick often enough to cover it
+		if(i % 8 == 0) up_down = left_right = 0;
+		float heading = randomRange(0, 360);
+
+		WheelCommands old_wheels = oldFieldCentricDrive(up_down, left_right, 0, 0, heading);
+		WheelCommands wheels = fieldCentricDrive(linear, up_down, left_right, 0, heading);
+		int difference = std::max({std::abs(wheels.left_front - old_wheels.left_front), std::abs(wheels.left_back - old_wheels.left_back),
+			std::abs(wheels.right_front - old_wheels.right_front), std::abs(wheels.right_back - old_wheels.right_back)});
+		if(difference <= CHECK_TOLERANCE){
+			worst = std::max(worst, difference);
+			continue;
+		}
+		if(mismatches == 0){
+			printf("driver.field_centric: stick %d %d heading %f gave %d %d %d %d, the old transform %d %d %d %d\n",
+				up_down, left_right, heading, wheels.left_front, wheels.left_back, wheels.right_front, wheels.right_back,
+				old_wheels.left_front, old_wheels.left_back, old_wheels.right_front, old_wheels.right_back);
+		}
+		mismatches += 1;
+	}
+	printf("driver.field_centric vs old: %ld inputs, %ld differ, largest difference %d (tolerance %d)\n\n",
+		(long)CHECK_INPUTS, mismatches, worst, CHECK_TOLERANCE);
+	return mismatches == 0;
+}
+
+/*=============
+** BENCHMARKS
+=============*/
+//Keeps results alive so the compiler can't drop the calls
+static volatile float sink;
+
+static void benchOdometry(std::size_t iterations){
+	Odometry odometry;
+	for(std::size_t i = 0; i < iterations; i++){
+		std::size_t n = i % BENCH_INPUTS;
+		odometryUpdate(odometry, inputs.left_encoder[n], inputs.right_encoder[n], inputs.center_encoder[n], inputs.heading[n]);
+	}
+	sink = odometry.pos_x + odometry.pos_y;
+}
+
+static void benchReferenceAngle(std::size_t iterations){
+	float total = 0;
+	for(std::size_t i = 0; i < iterations; i++){
+		std::size_t n = i % BENCH_INPUTS;
+		int reference_angle = referenceAngle(inputs.goal_x[n], inputs.goal_y[n], inputs.pos_x[n], inputs.pos_y[n]);
+		total += driveDirection(inputs.heading[n], reference_angle);
+	}
+	sink = total;
+}
+
+static void benchTurnDifference(std::size_t iterations){
+	float total = 0;
+	for(std::size_t i = 0; i < iterations; i++){
+		std::size_t n = i % BENCH_INPUTS;
+		total += turnDifference(inputs.heading[n], inputs.goal_heading[n]);
+	}
+	sink = total;
+}
+
+//One driver control tick on the robot: heading hold, then the field-centric transform
+static void benchFieldCentric(std::size_t iterations){
+	static const StickCurve curve (DRIVER_DEADBAND, DRIVER_EXPO);
+	HeadingHold heading_hold;
+	int total = 0;
+	for(std::size_t i = 0; i < iterations; i++){
+		std::size_t n = i % BENCH_INPUTS;
+		float turn = heading_hold.update(inputs.turnX[n], inputs.turnY[n], inputs.heading[n], inputs.gyro_rate[n]);
+		WheelCommands wheels = fieldCentricDrive(curve, inputs.up_down[n], inputs.left_right[n], turn, inputs.heading[n]);
+		total += wheels.left_front + wheels.left_back + wheels.right_front + wheels.right_back;
+	}
+	sink = total;
+}
+
+static void benchOldFieldCentric(std::size_t iterations){
+	int total = 0;
+	for(std::size_t i = 0; i < iterations; i++){
+		std::size_t n = i % BENCH_INPUTS;
+		WheelCommands wheels = oldFieldCentricDrive(inputs.up_down[n], inputs.left_right[n], inputs.turnX[n], inputs.turnY[n], inputs.heading[n]);
+		total += wheels.left_front + wheels.left_back + wheels.right_front + wheels.right_back;
+	}
+	sink = total;
+}
+
+static void benchMedianFilter(std::size_t iterations){
+	okapi::MedianFilter<5> median;
+	//Through the base class, the way a filtered sensor would call it
+	okapi::Filter& filter = median;
+	double total = 0;
+	for(std::size_t i = 0; i < iterations; i++){
+		total += filter.filter(inputs.reading[i % BENCH_INPUTS]);
+	}
+	sink = total;
+}
+
+struct Benchmark{
+	const char* name;
+	void (*run)(std::size_t iterations);
+};
+
+static const Benchmark benchmarks[] = {
+	{"odometry.update", benchOdometry},
+	{"drive.reference_angle", benchReferenceAngle},
+	{"drive.turn_difference", benchTurnDifference},
+	{"driver.field_centric", benchFieldCentric},
+	{"driver.field_centric_old", benchOldFieldCentric},
+	{"okapi.median_filter<5>", benchMedianFilter}
+};
+
+/*=============
+** TIMING
+=============*/
+typedef std::chrono::steady_clock Clock;
+
+static double timeRun(const Benchmark& benchmark, std::size_t iterations){
+	Clock::time_point start = Clock::now();
+	benchmark.run(iterations);
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void runBenchmark(const Benchmark& benchmark){
+	//Warm up, then double the iterations until a run is long enough to time
+	std::size_t iterations = BENCH_INPUTS;
+	timeRun(benchmark, iterations);
+	while(timeRun(benchmark, iterations) < BENCH_MIN_MS * 1e6) iterations *= 2;
+
+	double ns_per_op[BENCH_REPEATS];
+	std::size_t allocations_before = allocations;
+	for(int i = 0; i < BENCH_REPEATS; i++){
+		ns_per_op[i] = timeRun(benchmark, iterations) / iterations;
+	}
+	double allocs_per_op = (double)(allocations - allocations_before) / ((double)iterations * BENCH_REPEATS);
+
+	std::sort(ns_per_op, ns_per_op + BENCH_REPEATS);
+	printf("%-24s %10.2f %10.2f %10.3f %12zu\n", benchmark.name, ns_per_op[BENCH_REPEATS / 2], ns_per_op[0], allocs_per_op, iterations);
+}
+
+int main(int argc, char** argv){
+	if(argc > 2){
+		fprintf(stderr, "usage: %s [name]\n", argv[0]);
+		return 1;
+	}
+	const char* only = argc == 2 ? argv[1] : nullptr;
+
+	makeInputs();
+	if(checkFieldCentric() == false) return 1;
+
+	printf("%-24s %10s %10s %10s %12s\n", "benchmark", "ns/op", "min ns/op", "allocs/op", "iterations");
+	for(const Benchmark& benchmark : benchmarks){
+		if(only != nullptr && std::strstr(benchmark.name, only) == nullptr) continue;
+		runBenchmark(benchmark);
+	}
+	return 0;
+}
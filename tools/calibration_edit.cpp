@@ -0,0 +1,74 @@
+/*Shows or changes the robot's calibration file (see include/calibration.hpp).
+
+	calibration_edit calibration.bin                      prints what's in it
+	calibration_edit calibration.bin NAME=value...        sets those fields and writes it back
+
+	NAME is a CalibrationData field (left_scale=1.012). The tracking wheel scales come from a push test: zero
+	the encoders, roll the robot a measured distance in a straight line and divide the ticks it should have
+	counted by the ticks it did. A missing or unreadable file starts from the defaults, so this also makes a
+	new one; copy it to the root of the robot's SD card.*/
+
+#include "calibration.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void usage(const char* name){
+	fprintf(stderr, "usage: %s file [NAME=value]...\n", name);
+	std::exit(1);
+}
+
+static void print(const CalibrationData& data){
+	printf("gyro_bias=%g\n", data.gyro_bias);
+	printf("heading_drift=%g\n", data.heading_drift);
+	printf("left_scale=%g\n", data.left_scale);
+	printf("right_scale=%g\n", data.right_scale);
+	printf("center_scale=%g\n", data.center_scale);
+	printf("refreshes=%lu\n", (unsigned long)data.refreshes);
+}
+
+//NAME=value, false if there's no field by that name
+static bool set(CalibrationData& data, const char* assignment){
+	char name[32];
+	double value;
+	if(std::sscanf(assignment, "%31[^=]=%lf", name, &value) != 2) return false;
+
+	if(std::strcmp(name, "gyro_bias") == 0) data.gyro_bias = value;
+	else if(std::strcmp(name, "heading_drift") == 0) data.heading_drift = value;
+	else if(std::strcmp(name, "left_scale") == 0) data.left_scale = value;
+	else if(std::strcmp(name, "right_scale") == 0) data.right_scale = value;
+	else if(std::strcmp(name, "center_scale") == 0) data.center_scale = value;
+	else return false;
+	return true;
+}
+
+int main(int argc, char** argv){
+	if(argc < 2) usage(argv[0]);
+	const char* path = argv[1];
+
+	CalibrationData data;
+	bool loaded = loadCalibration(path, data);
+	if(argc == 2){
+		if(loaded == false){
+			fprintf(stderr, "%s: missing, from another version or corrupt\n", path);
+			return 1;
+		}
+		print(data);
+		return 0;
+	}
+
+	if(loaded == false) fprintf(stderr, "%s: not readable, starting from the defaults\n", path);
+	for(int i = 2; i < argc; i++){
+		if(set(data, argv[i]) == false){
+			fprintf(stderr, "%s: no field to set in %s\n", argv[0], argv[i]);
+			return 1;
+		}
+	}
+
+	if(saveCalibration(path, data) == false){
+		perror(path);
+		return 1;
+	}
+	print(data);
+	return 0;
+}
@@ -0,0 +1,286 @@
+/*Checks the autonomous routine against a stored golden run in the simulator (make golden).
+
+	golden [--update] [--golden file] [--pose-tolerance ticks] [--heading-tolerance deg] [--motor-tolerance mV]
+	       [--time-tolerance ms] [--sim path]
+
+	Runs autonomous() in the noiseless sim, recording the robot's true pose, the drive and feeder motor
+	commands and the balls scored every GOLDEN_SAMPLE_MS, and compares that trace with the golden one
+	(default sim/golden/autonomous.csv) sample by sample. It reports the first sample that differs by more
+	than the tolerances, the largest difference in every column and how much sooner or later the routine
+	finished, and exits with 1 if anything is out of tolerance, so a changed waypoint or constant can't move
+	the rest of the route unnoticed.
+
+	When the change is intended, --update records a new golden run over the old one; commit it with the change.*/
+
+#include "sim_run.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define GOLDEN_SAMPLE_MS 50
+
+enum Tolerance{
+	TOLERANCE_POSE,
+	TOLERANCE_HEADING,
+	TOLERANCE_MOTOR,
+	TOLERANCE_EXACT
+};
+
+struct Column{
+	const char* name;
+	Tolerance tolerance;
+};
+
+//Columns of the sim's --out trace that are compared
+static const Column COLUMNS[] = {
+	{"x", TOLERANCE_POSE},
+	{"y", TOLERANCE_POSE},
+	{"heading", TOLERANCE_HEADING},
+	{"left_front_mv", TOLERANCE_MOTOR},
+	{"left_back_mv", TOLERANCE_MOTOR},
+	{"right_front_mv", TOLERANCE_MOTOR},
+	{"right_back_mv", TOLERANCE_MOTOR},
+	{"feeder_top_mv", TOLERANCE_MOTOR},
+	{"feeder_middle_mv", TOLERANCE_MOTOR},
+	{"scored", TOLERANCE_EXACT}
+};
+
+#define COLUMN_COUNT (int)(sizeof(COLUMNS) / sizeof(COLUMNS[0]))
+
+struct Options{
+	bool update = false;
+	const char* golden_path = "sim/golden/autonomous.csv";
+	double tolerances[4] = {25, 3, 1500, 0};
+	long time_tolerance = 100;
+	std::string sim_path;
+};
+
+struct Trace{
+	long finished_ms = -1;          //-1 if the routine didn't finish
+	int scored = 0;
+	long start_ms = 0;
+	std::vector<long> times;
+	std::vector<std::vector<double>> rows;  //COLUMNS order
+};
+
+static void usage(const char* name){
+	fprintf(stderr, "usage: %s [--update] [--golden file] [--pose-tolerance ticks] [--heading-tolerance deg] [--motor-tolerance mV]\n"
+		"       [--time-tolerance ms] [--sim path]\n", name);
+	std::exit(1);
+}
+
+static Options parseOptions(int argc, char** argv){
+	Options options;
+	options.sim_path = defaultSimPath(argv[0]);
+
+	for(int i = 1; i < argc; i++){
+		const char* arg = argv[i];
+		if(std::strcmp(arg, "--update") == 0){
+			options.update = true;
+			continue;
+		}
+		if(i + 1 >= argc) usage(argv[0]);
+		const char* value = argv[++i];
+
+		if(std::strcmp(arg, "--golden") == 0) options.golden_path = value;
+		else if(std::strcmp(arg, "--pose-tolerance") == 0) options.tolerances[TOLERANCE_POSE] = std::atof(value);
+		else if(std::strcmp(arg, "--heading-tolerance") == 0) options.tolerances[TOLERANCE_HEADING] = std::atof(value);
+		else if(std::strcmp(arg, "--motor-tolerance") == 0) options.tolerances[TOLERANCE_MOTOR] = std::atof(value);
+		else if(std::strcmp(arg, "--time-tolerance") == 0) options.time_tolerance = std::atol(value);
+		else if(std::strcmp(arg, "--sim") == 0) options.sim_path = value;
+		else usage(argv[0]);
+	}
+	return options;
+}
+
+/*=============
+** TRACES
+=============*/
+//A golden file is the sim's --out CSV after a "# finished_ms=... scored=..." line
+static bool readTrace(const char* path, Trace& trace){
+	std::FILE* file = std::fopen(path, "r");
+	if(file == nullptr){
+		perror(path);
+		return false;
+	}
+
+	char line[1024];
+	int indices[COLUMN_COUNT];
+	bool header = false;
+	while(std::fgets(line, sizeof(line), file)){
+		if(line[0] == '#'){
+			std::sscanf(line, "# finished_ms=%ld scored=%d", &trace.finished_ms, &trace.scored);
+			continue;
+		}
+
+		//Split on commas
+		std::vector<std::string> fields;
+		for(char* field = std::strtok(line, ",\r\n"); field != nullptr; field = std::strtok(nullptr, ",\r\n")) fields.push_back(field);
+		if(fields.empty()) continue;
+
+		if(header == false){
+			if(fields[0] != "time") break;
+			for(int c = 0; c < COLUMN_COUNT; c++){
+				indices[c] = -1;
+				for(std::size_t f = 0; f < fields.size(); f++){
+					if(fields[f] == COLUMNS[c].name) indices[c] = f;
+				}
+				if(indices[c] < 0){
+					fprintf(stderr, "%s: no %s column\n", path, COLUMNS[c].name);
+					std::fclose(file);
+					return false;
+				}
+			}
+			header = true;
+			continue;
+		}
+
+		std::vector<double> row (COLUMN_COUNT);
+		for(int c = 0; c < COLUMN_COUNT; c++){
+			row[c] = (std::size_t)indices[c] < fields.size() ? std::atof(fields[indices[c]].c_str()) : 0;
+		}
+		//Relative to the start of autonomous(), so a faster initialize() doesn't shift everything
+		long time = std::atol(fields[0].c_str());
+		if(trace.times.empty()) trace.start_ms = time;
+		trace.times.push_back(time - trace.start_ms);
+		trace.rows.push_back(row);
+	}
+
+	std::fclose(file);
+	if(header == false){
+		fprintf(stderr, "%s: not a trajectory CSV\n", path);
+		return false;
+	}
+	return true;
+}
+
+//Runs the routine, leaving its trace in trace_path
+static bool recordTrace(const Options& options, const std::string& trace_path, Trace& trace){
+	std::string directory = makeRunDirectory("golden");
+	std::string run_path = directory + "/trace.csv";
+	SimRun run = runSim(options.sim_path, "--sample " + std::to_string(GOLDEN_SAMPLE_MS) + " --out '" + run_path + "'", directory + "/serial.bin");
+
+	bool ok = run.valid;
+	if(ok == false) fprintf(stderr, "the sim didn't complete (is it built? make sim)\n");
+
+	//The golden file carries the completion time the trace can't show
+	std::FILE* in = std::fopen(run_path.c_str(), "r");
+	std::FILE* out = ok ? std::fopen(trace_path.c_str(), "w") : nullptr;
+	if(ok && (in == nullptr || out == nullptr)){
+		perror(trace_path.c_str());
+		ok = false;
+	}
+	if(ok){
+		fprintf(out, "# finished_ms=%ld scored=%d\n", run.finished ? run.time_ms : -1, run.scored);
+		char buffer[4096];
+		std::size_t length;
+		while((length = std::fread(buffer, 1, sizeof(buffer), in)) > 0) std::fwrite(buffer, 1, length, out);
+	}
+	if(in != nullptr) std::fclose(in);
+	if(out != nullptr) std::fclose(out);
+
+	unlink(run_path.c_str());
+	removeRunDirectory(directory);
+	return ok && readTrace(trace_path.c_str(), trace);
+}
+
+/*=============
+** COMPARISON
+=============*/
+static double difference(const Column& column, double golden, double now){
+	double delta = std::abs(now - golden);
+	if(column.tolerance == TOLERANCE_HEADING && delta > 180) delta = 360 - delta;
+	return delta;
+}
+
+static void printFinish(const char* label, long finished_ms, int scored){
+	if(finished_ms < 0) printf("%-8s didn't finish, scored %d\n", label, scored);
+	else printf("%-8s finished after %ld ms, scored %d\n", label, finished_ms, scored);
+}
+
+//True if the runs match within the tolerances
+static bool compare(const Options& options, const Trace& golden, const Trace& now){
+	bool match = true;
+
+	printFinish("golden", golden.finished_ms, golden.scored);
+	printFinish("now", now.finished_ms, now.scored);
+	if(golden.finished_ms >= 0 && now.finished_ms >= 0){
+		long delta = now.finished_ms - golden.finished_ms;
+		printf("completion time %+ld ms\n", delta);
+		if(std::labs(delta) > options.time_tolerance) match = false;
+	}
+	else if(golden.finished_ms != now.finished_ms){
+		match = false;
+	}
+	if(golden.scored != now.scored) match = false;
+
+	double worst[COLUMN_COUNT] = {};
+	long worst_time[COLUMN_COUNT] = {};
+	bool diverged = false;
+	std::size_t samples = std::min(golden.rows.size(), now.rows.size());
+	for(std::size_t i = 0; i < samples; i++){
+		if(golden.times[i] != now.times[i]){
+			printf("sample %zu is at %ld ms in the golden trace but %ld ms now, were they recorded at the same rate?\n", i, golden.times[i], now.times[i]);
+			return false;
+		}
+		for(int c = 0; c < COLUMN_COUNT; c++){
+			double delta = difference(COLUMNS[c], golden.rows[i][c], now.rows[i][c]);
+			if(delta > worst[c]){
+				worst[c] = delta;
+				worst_time[c] = now.times[i];
+			}
+			if(delta > options.tolerances[COLUMNS[c].tolerance] && diverged == false){
+				printf("first divergence at %ld ms: %s %g, golden %g (tolerance %g)\n", now.times[i], COLUMNS[c].name,
+					now.rows[i][c], golden.rows[i][c], options.tolerances[COLUMNS[c].tolerance]);
+				printf("  pose there %.0f %.0f %.1f, golden %.0f %.0f %.1f\n", now.rows[i][0], now.rows[i][1], now.rows[i][2],
+					golden.rows[i][0], golden.rows[i][1], golden.rows[i][2]);
+				diverged = true;
+			}
+		}
+	}
+	if(diverged) match = false;
+	else if(golden.rows.size() != now.rows.size()) printf("traces agree until the shorter one ends\n");
+	else printf("traces agree within tolerances\n");
+
+	printf("\n%-18s %10s %10s %10s\n", "column", "max diff", "at ms", "tolerance");
+	for(int c = 0; c < COLUMN_COUNT; c++){
+		printf("%-18s %10.1f %10ld %10g\n", COLUMNS[c].name, worst[c], worst_time[c], options.tolerances[COLUMNS[c].tolerance]);
+	}
+	return match;
+}
+
+int main(int argc, char** argv){
+	Options options = parseOptions(argc, argv);
+
+	if(access(options.sim_path.c_str(), X_OK) != 0){
+		fprintf(stderr, "%s: no simulator at %s (make sim, or pass --sim)\n", argv[0], options.sim_path.c_str());
+		return 1;
+	}
+
+	if(options.update){
+		Trace trace;
+		if(recordTrace(options, options.golden_path, trace) == false) return 1;
+		printFinish("recorded", trace.finished_ms, trace.scored);
+		printf("wrote %zu samples to %s\n", trace.rows.size(), options.golden_path);
+		return 0;
+	}
+
+	Trace golden;
+	if(readTrace(options.golden_path, golden) == false) return 1;
+
+	std::string directory = makeRunDirectory("golden_now");
+	std::string now_path = directory + "/now.csv";
+	Trace now;
+	bool recorded = recordTrace(options, now_path, now);
+	unlink(now_path.c_str());
+	removeRunDirectory(directory);
+	if(recorded == false) return 1;
+
+	bool match = compare(options, golden, now);
+	printf("\n%s\n", match ? "PASS" : "FAIL: the route changed, rerun with --update if that was intended");
+	return match ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+/*Runs the autonomous routine many times in the simulator with random noise and reports how robust it is
+	(make monte_carlo).
+
+	monte_carlo [--runs n] [--jobs n] [--seed first] [--noise scale] [--duration s] [--min-score n] [--sim path]
+
+	Run i is `sim --seed first+i`, so every run draws its own encoder, inertial sensor, wheel slip, battery and
+	ball sensor biases (see sim/robot.hpp) and any of them can be repeated on its own. The robot code lives in
+	globals, so each run is its own sim process; a pool of --jobs threads (default one per core) keeps that
+	many running at once.
+
+	A noiseless run goes first as the reference. A run succeeds if autonomous() finished within --duration
+	seconds (default 60) and scored at least --min-score balls (default what the noiseless run scored). The
+	report shows the success rate, the scores, the spread of finishing times and the segments that fail most:
+	those a run was stuck in when time ran out, that ended differently from how they usually end (a goal
+	sensor drive that stopped on its position instead), or score segments that put fewer balls in than they
+	did in the noiseless run. A ball counts for the last score segment that started before it went in.*/
+
+#include "sim_run.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct RunResult{
+	std::uint32_t seed;
+	SimRun sim;
+};
+
+struct Options{
+	int runs = 100;
+	int jobs = 0;
+	std::uint32_t seed = 1;
+	double noise = 1;
+	double duration = 60;
+	int min_score = -1;          //-1 takes the noiseless run's score
+	std::string sim_path;
+};
+
+static void usage(const char* name){
+	fprintf(stderr, "usage: %s [--runs n] [--jobs n] [--seed first] [--noise scale] [--duration s] [--min-score n] [--sim path]\n", name);
+	std::exit(1);
+}
+
+static Options parseOptions(int argc, char** argv){
+	Options options;
+
+	options.sim_path = defaultSimPath(argv[0]);
+
+	for(int i = 1; i < argc; i++){
+		if(i + 1 >= argc) usage(argv[0]);
+		const char* arg = argv[i];
+		const char* value = argv[++i];
+
+		if(std::strcmp(arg, "--runs") == 0) options.runs = std::atoi(value);
+		else if(std::strcmp(arg, "--jobs") == 0) options.jobs = std::atoi(value);
+		else if(std::strcmp(arg, "--seed") == 0) options.seed = std::strtoul(value, nullptr, 10);
+		else if(std::strcmp(arg, "--noise") == 0) options.noise = std::atof(value);
+		else if(std::strcmp(arg, "--duration") == 0) options.duration = std::atof(value);
+		else if(std::strcmp(arg, "--min-score") == 0) options.min_score = std::atoi(value);
+		else if(std::strcmp(arg, "--sim") == 0) options.sim_path = value;
+		else usage(argv[0]);
+	}
+
+	if(options.jobs <= 0) options.jobs = std::max(1u, std::thread::hardware_concurrency());
+	if(options.runs <= 0 || options.duration <= 0 || options.noise < 0) usage(argv[0]);
+	return options;
+}
+
+/*=============
+** RUNNING
+=============*/
+static std::vector<RunResult> runAll(const Options& options, SimRun& noiseless){
+	std::string directory = makeRunDirectory("monte_carlo");
+	std::vector<RunResult> results (options.runs);
+
+	char arguments[128];
+	std::snprintf(arguments, sizeof(arguments), "--duration %g", options.duration);
+	noiseless = runSim(options.sim_path, arguments, directory + "/noiseless.bin");
+
+	runParallel(options.runs, options.jobs, "mc", [&](int i){
+		std::uint32_t seed = options.seed + i;
+		char arguments[128];
+		std::snprintf(arguments, sizeof(arguments), "--seed %u --noise %g --duration %g", seed, options.noise, options.duration);
+
+		results[i].seed = seed;
+		results[i].sim = runSim(options.sim_path, arguments, directory + "/run_" + std::to_string(seed) + ".bin");
+	});
+
+	removeRunDirectory(directory);
+	return results;
+}
+
+/*=============
+** REPORT
+=============*/
+//Nearest rank percentile of a sorted list
+static long percentile(const std::vector<long>& sorted, double fraction){
+	if(sorted.empty()) return 0;
+	std::size_t rank = (std::size_t)(fraction * (sorted.size() - 1) + 0.5);
+	return sorted[rank];
+}
+
+struct SegmentStats{
+	std::string kind;
+	double goal_x = 0;
+	double goal_y = 0;
+	std::vector<long> durations;
+	std::map<std::string, int> exits;
+	double position_error = 0;
+	int timed_out = 0;          //Runs that were stuck in it when time ran out
+	int unusual_exit = 0;       //Runs where it ended differently from most runs
+	int lost_runs = 0;          //Runs where it scored fewer balls than in the noiseless run
+	int lost_balls = 0;
+};
+
+static bool succeeded(const Options& options, const RunResult& run){
+	return run.sim.valid && run.sim.finished && run.sim.scored >= options.min_score;
+}
+
+static void printReport(const Options& options, const SimRun& noiseless, const std::vector<RunResult>& results){
+	int valid = 0, successes = 0;
+	std::map<int, int> scores;
+	std::vector<long> times;
+	for(const RunResult& run : results){
+		if(run.sim.valid == false) continue;
+		valid += 1;
+		if(succeeded(options, run)) successes += 1;
+		scores[run.sim.scored] += 1;
+		if(run.sim.finished) times.push_back(run.sim.time_ms);
+	}
+	std::sort(times.begin(), times.end());
+
+	printf("%d runs, noise x%g, %d jobs\n", options.runs, options.noise, options.jobs);
+	printf("noiseless run scored %d in %ld ms, success needs a score of %d\n", noiseless.scored, noiseless.time_ms, options.min_score);
+	if(valid < options.runs) printf("%d runs didn't complete (sim crashed or wasn't found at %s)\n", options.runs - valid, options.sim_path.c_str());
+	if(valid == 0) return;
+	printf("success  %d/%d (%.1f%%)\n", successes, valid, 100.0 * successes / valid);
+
+	printf("\nscore    ");
+	for(const auto& score : scores) printf("%d: %d  ", score.first, score.second);
+	printf("\n");
+
+	if(times.empty() == false){
+		long total = 0;
+		for(long time : times) total += time;
+		printf("time ms  min %ld  p10 %ld  p50 %ld  p90 %ld  max %ld  mean %ld  (%zu finished)\n",
+			times.front(), percentile(times, 0.1), percentile(times, 0.5), percentile(times, 0.9), times.back(),
+			total / (long)times.size(), times.size());
+	}
+
+	//Segments by index, the route is the same every run
+	std::vector<SegmentStats> segments;
+	std::vector<int> noiseless_goals = goalsBySegment(noiseless);
+	for(const RunResult& run : results){
+		if(run.sim.valid == false) continue;
+		std::vector<int> goals = goalsBySegment(run.sim);
+		for(std::size_t i = 0; i < run.sim.segments.size(); i++){
+			const SimSegment& segment = run.sim.segments[i];
+			if(i >= segments.size()){
+				segments.emplace_back();
+				segments[i].kind = segment.kind;
+				segments[i].goal_x = segment.goal_x;
+				segments[i].goal_y = segment.goal_y;
+			}
+			SegmentStats& stats = segments[i];
+			stats.durations.push_back(segment.duration_ms);
+			stats.exits[segment.exit] += 1;
+			stats.position_error += segment.position_error;
+			if(run.sim.finished == false && i + 1 == run.sim.segments.size()) stats.timed_out += 1;
+
+			int lost = i < noiseless_goals.size() ? noiseless_goals[i] - goals[i] : 0;
+			if(lost > 0){
+				stats.lost_runs += 1;
+				stats.lost_balls += lost;
+			}
+		}
+	}
+	for(std::size_t i = 0; i < segments.size(); i++){
+		SegmentStats& stats = segments[i];
+		auto usual = std::max_element(stats.exits.begin(), stats.exits.end(),
+			[](const std::pair<const std::string, int>& a, const std::pair<const std::string, int>& b){ return a.second < b.second; });
+		stats.unusual_exit = stats.durations.size() - usual->second;
+		stats.position_error /= stats.durations.size();
+		std::sort(stats.durations.begin(), stats.durations.end());
+	}
+
+	std::vector<std::size_t> order;
+	for(std::size_t i = 0; i < segments.size(); i++){
+		if(segments[i].timed_out > 0 || segments[i].unusual_exit > 0 || segments[i].lost_runs > 0) order.push_back(i);
+	}
+	std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){
+		int failures_a = segments[a].timed_out + segments[a].unusual_exit + segments[a].lost_runs;
+		int failures_b = segments[b].timed_out + segments[b].unusual_exit + segments[b].lost_runs;
+		if(failures_a != failures_b) return failures_a > failures_b;
+		return a < b;
+	});
+
+	printf("\nfailing segments\n");
+	if(order.empty()) printf("  none\n");
+	else printf("%3s %-6s %13s %9s %9s %11s %9s %8s %9s\n", "#", "kind", "goal", "timed out", "odd exit", "balls lost", "p50 ms", "p90 ms", "err ticks");
+	for(std::size_t i = 0; i < order.size() && i < 10; i++){
+		const SegmentStats& stats = segments[order[i]];
+		char goal[32];
+		std::snprintf(goal, sizeof(goal), "%.0f,%.0f", stats.goal_x, stats.goal_y);
+		printf("%3zu %-6s %13s %9d %9d %11d %9ld %8ld %9.0f\n", order[i], stats.kind.c_str(), goal, stats.timed_out, stats.unusual_exit,
+			stats.lost_balls, percentile(stats.durations, 0.5), percentile(stats.durations, 0.9), stats.position_error);
+	}
+
+	//So a failure can be replayed and watched with the sim on its own
+	int listed = 0;
+	for(const RunResult& run : results){
+		if(succeeded(options, run) || listed == 10) continue;
+		if(listed == 0) printf("\nfailed seeds (sim --seed n --noise %g):", options.noise);
+		printf(" %u", run.seed);
+		listed += 1;
+	}
+	if(listed > 0) printf("\n");
+}
+
+int main(int argc, char** argv){
+	Options options = parseOptions(argc, argv);
+
+	if(access(options.sim_path.c_str(), X_OK) != 0){
+		fprintf(stderr, "%s: no simulator at %s (make sim, or pass --sim)\n", argv[0], options.sim_path.c_str());
+		return 1;
+	}
+
+	SimRun noiseless;
+	std::vector<RunResult> results = runAll(options, noiseless);
+	if(noiseless.valid == false){
+		fprintf(stderr, "%s: the noiseless run didn't complete\n", argv[0]);
+		return 1;
+	}
+	if(options.min_score < 0) options.min_score = noiseless.scored;
+	printReport(options, noiseless, results);
+	return 0;
+}
@@ -0,0 +1,388 @@
+/*Tunes the drive() constants in include/drive_tuning.hpp against the simulator (make optimize).
+
+	optimize [--generations n] [--seeds k] [--noise scale] [--jobs n] [--seed n] [--sigma s] [--error-slack f]
+	         [--duration s] [--out file] [--sim path]
+
+	Searches KPBASE, KPBASETURN, CLOSE_MOVE and CLOSE_TURN with sep-CMA-ES (CMA-ES with a diagonal covariance,
+	Ros and Hansen 2008) for the fastest autonomous routine that is still as good as the current constants:
+	every run finishes, it scores at least as many balls on average and its segments end no further from
+	their goals on average than --error-slack (default 0.25, so 25%) more than now. Each candidate is run on
+	--seeds noisy runs (default 4, see sim --seed), the same seeds for every candidate, so the constants don't
+	only work on a perfect robot; --seeds 0 uses a single noiseless run. A generation's runs are spread over
+	--jobs threads (default one per core), each running a sim process.
+
+	The best candidate that met the constraints is written to --out (default drive_tuning.hpp in the working
+	directory) in the same form as include/drive_tuning.hpp, ready to copy over it. The per-call speeds and
+	tolerances in autonomous() aren't searched: there are hundreds of them and each only matters to its own
+	segment.*/
+
+#include "drive_tuning.hpp"
+#include "sim_run.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+//Costs of missing a constraint, in ms of route time
+#define UNFINISHED_PENALTY_MS 20000
+#define SCORE_PENALTY_MS 5000
+#define ERROR_PENALTY_MS 50
+#define BOUNDS_PENALTY_MS 100000
+
+//First noise seed, far from the ones monte_carlo starts at
+#define FIRST_NOISE_SEED 1000
+
+struct Parameter{
+	const char* name;
+	double initial;
+	double low;
+	double high;
+	double step;        //Values are rounded to this before they're tried, so the header holds what was run
+};
+
+static const Parameter PARAMETERS[] = {
+	{"KPBASE", KPBASE, 0.02, 0.5, 0.001},
+	{"KPBASETURN", KPBASETURN, 0.02, 0.5, 0.001},
+	{"CLOSE_MOVE", CLOSE_MOVE, 100, 1200, 1},
+	{"CLOSE_TURN", CLOSE_TURN, 5, 90, 0.1}
+};
+
+#define DIMENSIONS (int)(sizeof(PARAMETERS) / sizeof(PARAMETERS[0]))
+
+struct Options{
+	int generations = 30;
+	int seeds = 4;
+	double noise = 1;
+	int jobs = 0;
+	std::uint32_t seed = 1;
+	double sigma = 0.2;
+	double error_slack = 0.25;
+	double duration = 60;
+	const char* out_path = "drive_tuning.hpp";
+	std::string sim_path;
+};
+
+static void usage(const char* name){
+	fprintf(stderr, "usage: %s [--generations n] [--seeds k] [--noise scale] [--jobs n] [--seed n] [--sigma s] [--error-slack f]\n"
+		"       [--duration s] [--out file] [--sim path]\n", name);
+	std::exit(1);
+}
+
+static Options parseOptions(int argc, char** argv){
+	Options options;
+	options.sim_path = defaultSimPath(argv[0]);
+
+	for(int i = 1; i < argc; i++){
+		if(i + 1 >= argc) usage(argv[0]);
+		const char* arg = argv[i];
+		const char* value = argv[++i];
+
+		if(std::strcmp(arg, "--generations") == 0) options.generations = std::atoi(value);
+		else if(std::strcmp(arg, "--seeds") == 0) options.seeds = std::atoi(value);
+		else if(std::strcmp(arg, "--noise") == 0) options.noise = std::atof(value);
+		else if(std::strcmp(arg, "--jobs") == 0) options.jobs = std::atoi(value);
+		else if(std::strcmp(arg, "--seed") == 0) options.seed = std::strtoul(value, nullptr, 10);
+		else if(std::strcmp(arg, "--sigma") == 0) options.sigma = std::atof(value);
+		else if(std::strcmp(arg, "--error-slack") == 0) options.error_slack = std::atof(value);
+		else if(std::strcmp(arg, "--duration") == 0) options.duration = std::atof(value);
+		else if(std::strcmp(arg, "--out") == 0) options.out_path = value;
+		else if(std::strcmp(arg, "--sim") == 0) options.sim_path = value;
+		else usage(argv[0]);
+	}
+
+	if(options.jobs <= 0) options.jobs = std::max(1u, std::thread::hardware_concurrency());
+	if(options.generations <= 0 || options.seeds < 0 || options.sigma <= 0 || options.duration <= 0) usage(argv[0]);
+	return options;
+}
+
+/*=============
+** EVALUATION
+=============*/
+typedef std::vector<double> Vector;
+
+struct Evaluation{
+	Vector values;          //Parameter values that were run
+	bool feasible = false;
+	double cost = 0;
+	double time_ms = 0;     //Mean over the runs, unfinished runs count as the whole period
+	double score = 0;
+	double error = 0;
+	int unfinished = 0;
+};
+
+//The search works on [0, 1] for every parameter
+static Vector toValues(const Vector& x){
+	Vector values (DIMENSIONS);
+	for(int i = 0; i < DIMENSIONS; i++){
+		const Parameter& parameter = PARAMETERS[i];
+		double value = parameter.low + std::clamp(x[i], 0.0, 1.0) * (parameter.high - parameter.low);
+		values[i] = std::round(value / parameter.step) * parameter.step;
+	}
+	return values;
+}
+
+static Vector toSearch(const Vector& values){
+	Vector x (DIMENSIONS);
+	for(int i = 0; i < DIMENSIONS; i++) x[i] = (values[i] - PARAMETERS[i].low) / (PARAMETERS[i].high - PARAMETERS[i].low);
+	return x;
+}
+
+static std::string simArguments(const Options& options, const Vector& values, int run){
+	char arguments[512];
+	int length = std::snprintf(arguments, sizeof(arguments), "--duration %g", options.duration);
+	if(options.seeds > 0) length += std::snprintf(arguments + length, sizeof(arguments) - length, " --seed %d --noise %g", FIRST_NOISE_SEED + run, options.noise);
+	for(int i = 0; i < DIMENSIONS; i++){
+		length += std::snprintf(arguments + length, sizeof(arguments) - length, " --set %s=%g", PARAMETERS[i].name, values[i]);
+	}
+	return arguments;
+}
+
+//Runs every candidate on every seed at once, so the pool stays busy across candidates
+static std::vector<Evaluation> evaluate(const Options& options, const std::vector<Vector>& candidates, const char* label){
+	int runs_each = std::max(1, options.seeds);
+	int count = candidates.size() * runs_each;
+	std::vector<SimRun> runs (count);
+
+	std::string directory = makeRunDirectory("optimize");
+	runParallel(count, options.jobs, label, [&](int i){
+		const Vector& values = candidates[i / runs_each];
+		runs[i] = runSim(options.sim_path, simArguments(options, values, i % runs_each), directory + "/run_" + std::to_string(i) + ".bin");
+	});
+	removeRunDirectory(directory);
+
+	std::vector<Evaluation> evaluations (candidates.size());
+	for(std::size_t c = 0; c < candidates.size(); c++){
+		Evaluation& evaluation = evaluations[c];
+		evaluation.values = candidates[c];
+		for(int r = 0; r < runs_each; r++){
+			const SimRun& run = runs[c * runs_each + r];
+			if(run.valid == false || run.finished == false){
+				evaluation.unfinished += 1;
+				evaluation.time_ms += options.duration * 1000;
+			}
+			else{
+				evaluation.time_ms += run.time_ms;
+			}
+			evaluation.score += run.scored;
+			evaluation.error += meanPositionError(run);
+		}
+		evaluation.time_ms /= runs_each;
+		evaluation.score /= runs_each;
+		evaluation.error /= runs_each;
+	}
+	return evaluations;
+}
+
+//Route time plus the cost of every constraint it misses, against the current constants
+static void score(const Options& options, const Evaluation& baseline, Evaluation& evaluation){
+	double score_deficit = std::max(0.0, baseline.score - evaluation.score);
+	double error_excess = std::max(0.0, evaluation.error - baseline.error * (1 + options.error_slack));
+
+	evaluation.cost = evaluation.time_ms + evaluation.unfinished * UNFINISHED_PENALTY_MS + score_deficit * SCORE_PENALTY_MS +
+		error_excess * ERROR_PENALTY_MS;
+	evaluation.feasible = evaluation.unfinished == 0 && score_deficit == 0 && error_excess == 0;
+}
+
+/*=============
+** SEP-CMA-ES
+=============*/
+//Standard settings for n dimensions, with the faster covariance learning rates of the diagonal variant
+struct Strategy{
+	int lambda;
+	int mu;
+	Vector weights;
+	double mueff;
+	double cc;
+	double cs;
+	double c1;
+	double cmu;
+	double damps;
+	double chi_n;
+
+	Strategy(int n){
+		lambda = 4 + (int)(3 * std::log(n));
+		mu = lambda / 2;
+
+		double total = 0;
+		for(int i = 0; i < mu; i++){
+			weights.push_back(std::log(mu + 0.5) - std::log(i + 1));
+			total += weights.back();
+		}
+		double squares = 0;
+		for(double& weight : weights){
+			weight /= total;
+			squares += weight * weight;
+		}
+		mueff = 1 / squares;
+
+		cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+		cs = (mueff + 2) / (n + mueff + 5);
+		c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff) * (n + 2) / 3;
+		cmu = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((n + 2) * (n + 2) + mueff) * (n + 2) / 3);
+		damps = 1 + 2 * std::max(0.0, std::sqrt((mueff - 1) / (n + 1)) - 1) + cs;
+		chi_n = std::sqrt(n) * (1 - 1.0 / (4 * n) + 1.0 / (21 * n * n));
+	}
+};
+
+static void printEvaluation(const char* label, const Evaluation& evaluation){
+	printf("%-10s", label);
+	for(int i = 0; i < DIMENSIONS; i++) printf(" %s=%g", PARAMETERS[i].name, evaluation.values[i]);
+	printf("  time %.0f ms  score %.2f  error %.0f ticks%s\n", evaluation.time_ms, evaluation.score, evaluation.error,
+		evaluation.feasible ? "" : "  (misses constraints)");
+}
+
+static Evaluation search(const Options& options, const Evaluation& baseline){
+	const int n = DIMENSIONS;
+	Strategy strategy (n);
+	std::mt19937 random (options.seed);
+	std::normal_distribution<double> normal (0, 1);
+
+	Vector values (n);
+	for(int i = 0; i < n; i++) values[i] = PARAMETERS[i].initial;
+	Vector mean = toSearch(values);
+	Vector diagonal (n, 1);     //Covariance, one variance per parameter
+	Vector path_c (n, 0);
+	Vector path_s (n, 0);
+	double sigma = options.sigma;
+
+	Evaluation best = baseline;
+
+	for(int generation = 0; generation < options.generations; generation++){
+		std::vector<Vector> z (strategy.lambda, Vector(n));
+		std::vector<Vector> x (strategy.lambda, Vector(n));
+		std::vector<Vector> candidates;
+		for(int k = 0; k < strategy.lambda; k++){
+			for(int i = 0; i < n; i++){
+				z[k][i] = normal(random);
+				x[k][i] = mean[i] + sigma * std::sqrt(diagonal[i]) * z[k][i];
+			}
+			candidates.push_back(toValues(x[k]));
+		}
+
+		char label[32];
+		std::snprintf(label, sizeof(label), "gen %d", generation + 1);
+		std::vector<Evaluation> evaluations = evaluate(options, candidates, label);
+
+		//Candidates outside the bounds were run clamped, the penalty pulls the search back inside
+		std::vector<int> order (strategy.lambda);
+		for(int k = 0; k < strategy.lambda; k++){
+			score(options, baseline, evaluations[k]);
+			for(int i = 0; i < n; i++){
+				double outside = x[k][i] - std::clamp(x[k][i], 0.0, 1.0);
+				if(outside != 0){
+					evaluations[k].cost += outside * outside * BOUNDS_PENALTY_MS;
+					evaluations[k].feasible = false;
+				}
+			}
+			order[k] = k;
+		}
+		std::sort(order.begin(), order.end(), [&](int a, int b){ return evaluations[a].cost < evaluations[b].cost; });
+
+		for(int k = 0; k < strategy.lambda; k++){
+			const Evaluation& evaluation = evaluations[k];
+			if(evaluation.feasible && evaluation.time_ms < best.time_ms) best = evaluation;
+		}
+		printEvaluation(label, evaluations[order[0]]);
+
+		//Recombination of the best mu steps
+		Vector y_w (n, 0);
+		Vector z_w (n, 0);
+		for(int j = 0; j < strategy.mu; j++){
+			int k = order[j];
+			for(int i = 0; i < n; i++){
+				y_w[i] += strategy.weights[j] * std::sqrt(diagonal[i]) * z[k][i];
+				z_w[i] += strategy.weights[j] * z[k][i];
+			}
+		}
+		for(int i = 0; i < n; i++) mean[i] += sigma * y_w[i];
+
+		//Evolution paths
+		double norm_s = 0;
+		for(int i = 0; i < n; i++){
+			path_s[i] = (1 - strategy.cs) * path_s[i] + std::sqrt(strategy.cs * (2 - strategy.cs) * strategy.mueff) * z_w[i];
+			norm_s += path_s[i] * path_s[i];
+		}
+		norm_s = std::sqrt(norm_s);
+		bool h_sigma = norm_s / std::sqrt(1 - std::pow(1 - strategy.cs, 2 * (generation + 1))) / strategy.chi_n < 1.4 + 2.0 / (n + 1);
+		for(int i = 0; i < n; i++){
+			path_c[i] = (1 - strategy.cc) * path_c[i] + (h_sigma ? std::sqrt(strategy.cc * (2 - strategy.cc) * strategy.mueff) * y_w[i] : 0);
+		}
+
+		//Diagonal covariance and step size
+		for(int i = 0; i < n; i++){
+			double rank_mu = 0;
+			for(int j = 0; j < strategy.mu; j++){
+				double y = std::sqrt(diagonal[i]) * z[order[j]][i];
+				rank_mu += strategy.weights[j] * y * y;
+			}
+			double rank_one = path_c[i] * path_c[i] + (h_sigma ? 0 : strategy.cc * (2 - strategy.cc) * diagonal[i]);
+			diagonal[i] = (1 - strategy.c1 - strategy.cmu) * diagonal[i] + strategy.c1 * rank_one + strategy.cmu * rank_mu;
+		}
+		sigma *= std::exp(strategy.cs / strategy.damps * (norm_s / strategy.chi_n - 1));
+	}
+
+	return best;
+}
+
+/*=============
+** OUTPUT
+=============*/
+static bool writeHeader(const Options& options, const Evaluation& baseline, const Evaluation& best){
+	std::FILE* file = std::fopen(options.out_path, "w");
+	if(file == nullptr){
+		perror(options.out_path);
+		return false;
+	}
+
+	const Vector& values = best.values;
+	fprintf(file, "#ifndef _DRIVE_TUNING_HPP_\n#define _DRIVE_TUNING_HPP_\n\n");
+	fprintf(file, "/*=============\n** DRIVE TUNING\n=============*/\n");
+	fprintf(file, "/*Gains and thresholds of drive(). tools/optimize.cpp (make optimize) writes a file like this one from\n"
+		"\tsimulated runs of the autonomous routine; copy it over this one to use its values.\n\n");
+	fprintf(file, "\tWritten by optimize after %d generations on %d %s: %.0f ms (was %.0f), score %.2f (was %.2f),\n"
+		"\tsegment error %.0f ticks (was %.0f).*/\n\n", options.generations, std::max(1, options.seeds),
+		options.seeds > 0 ? "noisy runs" : "noiseless run", best.time_ms, baseline.time_ms, best.score, baseline.score, best.error, baseline.error);
+	fprintf(file, "//Share of move/turn speed left when the robot is right on its goal\n");
+	fprintf(file, "#define KPBASE %g\n#define KPBASETURN %g\n\n", values[0], values[1]);
+	fprintf(file, "//Distance (ticks) and heading error (degrees) where drive() starts slowing down\n");
+	fprintf(file, "#define CLOSE_MOVE %g\n#define CLOSE_TURN %g\n\n#endif\n", values[2], values[3]);
+
+	std::fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv){
+	Options options = parseOptions(argc, argv);
+
+	if(access(options.sim_path.c_str(), X_OK) != 0){
+		fprintf(stderr, "%s: no simulator at %s (make sim, or pass --sim)\n", argv[0], options.sim_path.c_str());
+		return 1;
+	}
+
+	Vector initial (DIMENSIONS);
+	for(int i = 0; i < DIMENSIONS; i++) initial[i] = PARAMETERS[i].initial;
+	Evaluation baseline = evaluate(options, {initial}, "baseline")[0];
+	if(baseline.unfinished > 0){
+		fprintf(stderr, "%s: the current constants don't finish the routine in %g s, nothing to hold candidates to\n", argv[0], options.duration);
+		return 1;
+	}
+	score(options, baseline, baseline);
+	printEvaluation("baseline", baseline);
+
+	Evaluation best = search(options, baseline);
+	printEvaluation("best", best);
+
+	if(best.values == baseline.values){
+		printf("no candidate beat the current constants, %s not written\n", options.out_path);
+		return 0;
+	}
+	if(writeHeader(options, baseline, best) == false) return 1;
+	printf("wrote %s\n", options.out_path);
+	return 0;
+}
@@ -0,0 +1,195 @@
+/*Records telemetry frames through FlightRecorder's double buffer and decodes the file it writes (make test).
+
+	recorder_test [frames]
+
+	The writer task is held back while frames go in, so both buffers fill and the recorder has to drop
+	frames, then let go so it catches up. Every frame record() accepted must come back out of the file
+	exactly and in order, with no sequence gaps: a dropped frame may be missing from the file but must not
+	break the delta encoding of the frames after it. Exits with 1 if anything didn't decode.
+
+	The PROS calls the recorder makes (tasks, notifications, mutexes, the SD card check) are stood in for by
+	threads, a condition variable and std::timed_mutex. The file goes to a temporary directory.*/
+
+#include "recorder.hpp"
+#include "telemetry_codec.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+//Enough frames that the accepted ones after the drop fill a buffer more than once
+#define TEST_FRAMES 2000
+
+typedef std::chrono::steady_clock Clock;
+
+/*=============
+** PROS STAND-INS
+=============*/
+//The recorder has one writer task, so one notification count is enough
+static std::mutex notify_mutex;
+static std::condition_variable notify_signal;
+static std::uint32_t notify_count = 0;
+//While true the writer sleeps through its notifications, so the buffers back up
+static bool writer_held = false;
+static const Clock::time_point start_time = Clock::now();
+
+namespace pros{
+namespace c{
+
+std::uint32_t millis(){
+	return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count();
+}
+
+void delay(const std::uint32_t milliseconds){
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+std::uint32_t task_notify(task_t){
+	std::lock_guard<std::mutex> lock (notify_mutex);
+	notify_count += 1;
+	notify_signal.notify_one();
+	return 1;
+}
+
+}
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t, std::uint16_t, const char*){
+	std::thread (function, parameters).detach();
+	task = reinterpret_cast<task_t>(1);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout){
+	std::unique_lock<std::mutex> lock (notify_mutex);
+	notify_signal.wait_for(lock, std::chrono::milliseconds(timeout), []{ return notify_count > 0 && writer_held == false; });
+	if(writer_held == true) return 0;
+	std::uint32_t count = notify_count;
+	if(count > 0) notify_count = clear_on_exit ? 0 : count - 1;
+	return count;
+}
+
+Mutex::Mutex() : mutex(std::make_shared<std::timed_mutex>()) {}
+
+bool Mutex::take(std::uint32_t timeout){
+	return static_cast<std::timed_mutex*>(mutex.get())->try_lock_for(std::chrono::milliseconds(timeout));
+}
+
+bool Mutex::give(){
+	static_cast<std::timed_mutex*>(mutex.get())->unlock();
+	return true;
+}
+
+namespace usd{
+
+std::int32_t is_installed(){
+	return 1;
+}
+
+}
+}
+
+static void holdWriter(bool held){
+	std::lock_guard<std::mutex> lock (notify_mutex);
+	writer_held = held;
+	notify_signal.notify_one();
+}
+
+/*=============
+** TEST
+=============*/
+//Fields that change by different amounts each frame, like a robot driving along
+static TelemetryFrame makeFrame(int i){
+	TelemetryFrame frame;
+	for(int field = 0; field < TLM_FIELD_COUNT; field++) frame.values[field] = (field + 1) * i + (i * i) % (field + 7);
+	frame.values[TLM_TIME] = i * 10;
+	return frame;
+}
+
+static bool readPackets(const char* path, std::vector<TelemetryFrame>& frames, std::uint32_t& missed, int& rejected){
+	std::FILE* file = std::fopen(path, "rb");
+	if(file == nullptr){
+		perror(path);
+		return false;
+	}
+
+	TelemetryDecoder decoder;
+	std::uint8_t packet[TELEMETRY_MAX_PACKET_SIZE];
+	std::size_t packet_size = 0;
+	int byte;
+	while((byte = std::fgetc(file)) != EOF){
+		if(byte != 0){
+			if(packet_size < sizeof(packet)) packet[packet_size] = byte;
+			packet_size += 1;
+			continue;
+		}
+
+		TelemetryFrame frame;
+		if(packet_size <= sizeof(packet) && decoder.decode(packet, packet_size, frame)) frames.push_back(frame);
+		else rejected += 1;
+		packet_size = 0;
+	}
+
+	std::fclose(file);
+	missed = decoder.missed();
+	return true;
+}
+
+int main(int argc, char** argv){
+	int count = argc > 1 ? std::atoi(argv[1]) : TEST_FRAMES;
+	if(count <= 0){
+		fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+		return 1;
+	}
+
+	char directory[] = "/tmp/recorder_test_XXXXXX";
+	if(mkdtemp(directory) == nullptr || chdir(directory) != 0){
+		perror(directory);
+		return 1;
+	}
+
+	static FlightRecorder recorder;
+	if(recorder.start() == false){
+		fprintf(stderr, "recorder didn't start\n");
+		return 1;
+	}
+
+	//Holds the writer until the first drop, then lets it catch up while the frames keep coming
+	std::vector<TelemetryFrame> accepted;
+	holdWriter(true);
+	for(int i = 0; i < count; i++){
+		TelemetryFrame frame = makeFrame(i);
+		if(recorder.record(frame)) accepted.push_back(frame);
+		else if(writer_held == true && recorder.dropped() >= 20) holdWriter(false);
+		if(writer_held == false) std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	holdWriter(false);
+	recorder.flush();
+
+	std::vector<TelemetryFrame> decoded;
+	std::uint32_t missed = 0;
+	int rejected = 0;
+	bool read = readPackets("flight_00.bin", decoded, missed, rejected);
+	std::remove("flight_00.bin");
+	rmdir(directory);
+	if(read == false) std::_Exit(1);
+
+	int wrong = 0;
+	for(std::size_t i = 0; i < accepted.size() && i < decoded.size(); i++){
+		if(std::memcmp(&accepted[i], &decoded[i], sizeof(TelemetryFrame)) != 0) wrong += 1;
+	}
+
+	printf("%d frames, %zu accepted, %lu dropped, %zu decoded, %d wrong, %lu missed, %d rejected\n", count, accepted.size(),
+		(unsigned long)recorder.dropped(), decoded.size(), wrong, (unsigned long)missed, rejected);
+
+	bool passed = recorder.dropped() > 0 && decoded.size() == accepted.size() && wrong == 0 && missed == 0 && rejected == 0;
+	if(recorder.dropped() == 0) printf("no frame was dropped, the drop path wasn't tested\n");
+	printf(passed ? "PASS\n" : "FAIL\n");
+
+	//The writer thread never returns (like the task on the robot), the static destructors would wait on it forever
+	std::fflush(stdout);
+	std::_Exit(passed ? 0 : 1);
+}
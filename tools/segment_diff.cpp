@@ -0,0 +1,100 @@
+/*Compares the autonomous segment logs of two runs (see include/segments.hpp).
+
+	segment_diff before.csv after.csv [threshold_ms]
+
+	Either file can be the segments.csv from the SD card or a saved serial log, in which case only the lines
+	starting with "[seg] " are read. Segments are matched by index; a segment that got slower by more than
+	threshold_ms (default 50) or ended for a different reason is marked as a regression.
+
+	Segments that run together under all() both count their full time in the total, so the time the route
+	took (when its last segment ended) is printed as well.*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct SegmentRow{
+	int index;
+	char kind[16];
+	long end_ms;
+	long duration_ms;
+	char exit[16];
+	double position_error;
+	double heading_error;
+};
+
+static bool readSegments(const char* path, std::vector<SegmentRow>& rows){
+	std::FILE* file = std::fopen(path, "r");
+	if(file == nullptr){
+		perror(path);
+		return false;
+	}
+
+	char line[512];
+	while(std::fgets(line, sizeof(line), file)){
+		const char* text = line;
+		if(std::strncmp(text, "[seg] ", 6) == 0) text += 6;
+
+		//Header and anything else that isn't a segment line
+		SegmentRow row;
+		long start_ms;
+		double goal_x, goal_y, goal_heading;
+		if(std::sscanf(text, "%d,%15[^,],%ld,%ld,%ld,%15[^,],%lf,%lf,%lf,%lf,%lf", &row.index, row.kind, &start_ms, &row.end_ms,
+			&row.duration_ms, row.exit, &goal_x, &goal_y, &goal_heading, &row.position_error, &row.heading_error) != 11) continue;
+
+		//A serial log may hold several runs, only the last one counts
+		if(row.index == 0) rows.clear();
+		rows.push_back(row);
+	}
+
+	std::fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv){
+	if(argc < 3 || argc > 4){
+		fprintf(stderr, "usage: %s <before> <after> [threshold_ms]\n", argv[0]);
+		return 1;
+	}
+	long threshold_ms = argc == 4 ? std::atol(argv[3]) : 50;
+
+	std::vector<SegmentRow> before, after;
+	if(readSegments(argv[1], before) == false || readSegments(argv[2], after) == false) return 1;
+
+	printf("%3s %-6s %8s %8s %7s  %-12s %-12s %9s %8s\n", "#", "kind", "before", "after", "delta", "exit before", "exit after", "err ticks", "err deg");
+
+	long total_before = 0, total_after = 0;
+	long end_before = 0, end_after = 0;
+	for(const SegmentRow& row : before) if(row.end_ms > end_before) end_before = row.end_ms;
+	for(const SegmentRow& row : after) if(row.end_ms > end_after) end_after = row.end_ms;
+	int regressions = 0;
+	std::size_t count = before.size() > after.size() ? before.size() : after.size();
+
+	for(std::size_t i = 0; i < count; i++){
+		if(i >= before.size() || i >= after.size()){
+			const SegmentRow& row = i < before.size() ? before[i] : after[i];
+			printf("%3d %-6s only in the %s run\n", row.index, row.kind, i < before.size() ? "before" : "after");
+			regressions += 1;
+			continue;
+		}
+
+		const SegmentRow& old_row = before[i];
+		const SegmentRow& new_row = after[i];
+		long delta = new_row.duration_ms - old_row.duration_ms;
+		total_before += old_row.duration_ms;
+		total_after += new_row.duration_ms;
+
+		bool regressed = delta > threshold_ms || std::strcmp(old_row.exit, new_row.exit) != 0 || std::strcmp(old_row.kind, new_row.kind) != 0;
+		if(regressed) regressions += 1;
+
+		printf("%3d %-6s %8ld %8ld %+7ld  %-12s %-12s %+9.1f %+8.1f%s\n", new_row.index, new_row.kind,
+			old_row.duration_ms, new_row.duration_ms, delta, old_row.exit, new_row.exit,
+			new_row.position_error - old_row.position_error, new_row.heading_error - old_row.heading_error,
+			regressed ? "  <<" : "");
+	}
+
+	printf("total %ld ms -> %ld ms (%+ld ms), %d regressed segments\n", total_before, total_after, total_after - total_before, regressions);
+	printf("route %ld ms -> %ld ms (%+ld ms)\n", end_before, end_after, end_after - end_before);
+	return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,129 @@
+#include "sim_run.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+std::string defaultSimPath(const char* argv0){
+	std::string self = argv0;
+	std::size_t slash = self.rfind('/');
+	return (slash == std::string::npos ? std::string(".") : self.substr(0, slash)) + "/sim";
+}
+
+//The "[seg] " lines the robot printed over serial at the end of the run
+static void readSegments(const char* path, std::vector<SimSegment>& segments){
+	std::FILE* file = std::fopen(path, "rb");
+	if(file == nullptr) return;
+
+	char line[512];
+	while(std::fgets(line, sizeof(line), file)){
+		if(std::strncmp(line, "[seg] ", 6) != 0) continue;
+
+		SimSegment segment;
+		int index;
+		double goal_heading, heading_error;
+		if(std::sscanf(line + 6, "%d,%15[^,],%ld,%ld,%ld,%15[^,],%lf,%lf,%lf,%lf,%lf", &index, segment.kind, &segment.start_ms, &segment.end_ms,
+			&segment.duration_ms, segment.exit, &segment.goal_x, &segment.goal_y, &goal_heading, &segment.position_error, &heading_error) != 11) continue;
+
+		if(index == 0) segments.clear();
+		segments.push_back(segment);
+	}
+
+	std::fclose(file);
+}
+
+SimRun runSim(const std::string& sim_path, const std::string& arguments, const std::string& serial_path){
+	SimRun run;
+
+	std::string command = "'" + sim_path + "' --no-sd --serial '" + serial_path + "' " + arguments + " 2>&1";
+	std::FILE* output = popen(command.c_str(), "r");
+	if(output == nullptr) return run;
+
+	char line[256];
+	bool summary = false;
+	while(std::fgets(line, sizeof(line), output)){
+		long time_ms;
+		int scored, scored_theirs, goal;
+		if(std::sscanf(line, "[sim] autonomous finished after %ld ms", &time_ms) == 1){
+			run.finished = true;
+			run.time_ms = time_ms;
+		}
+		else if(std::sscanf(line, "[sim] autonomous stopped after %ld ms", &time_ms) == 1){
+			run.time_ms = time_ms;
+		}
+		else if(std::sscanf(line, "[sim] scored %d (%d of theirs)", &scored, &scored_theirs) == 2){
+			run.scored = scored;
+			run.scored_theirs = scored_theirs;
+			summary = true;
+		}
+		else if(std::sscanf(line, "[sim] goal %d at %ld ms", &goal, &time_ms) == 2){
+			run.goal_times.push_back(time_ms);
+		}
+	}
+	run.valid = pclose(output) == 0 && summary;
+
+	readSegments(serial_path.c_str(), run.segments);
+	unlink(serial_path.c_str());
+	return run;
+}
+
+double meanPositionError(const SimRun& run){
+	if(run.segments.empty()) return 0;
+	double total = 0;
+	for(const SimSegment& segment : run.segments) total += segment.position_error;
+	return total / run.segments.size();
+}
+
+std::vector<int> goalsBySegment(const SimRun& run){
+	std::vector<int> goals (run.segments.size(), 0);
+	for(long time : run.goal_times){
+		int segment = -1;
+		for(std::size_t i = 0; i < run.segments.size(); i++){
+			if(std::strcmp(run.segments[i].kind, "score") == 0 && run.segments[i].start_ms <= time) segment = i;
+		}
+		if(segment >= 0) goals[segment] += 1;
+	}
+	return goals;
+}
+
+void runParallel(int count, int threads, const char* label, const std::function<void(int)>& job){
+	std::atomic<int> next {0};
+	int done = 0;
+	std::mutex progress_mutex;
+
+	auto worker = [&]{
+		while(true){
+			int i = next++;
+			if(i >= count) return;
+			job(i);
+
+			std::lock_guard<std::mutex> lock (progress_mutex);
+			done += 1;
+			if(label != nullptr) fprintf(stderr, "\r[%s] %d/%d", label, done, count);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for(int i = 0; i < std::min(threads, count); i++) pool.emplace_back(worker);
+	for(std::thread& thread : pool) thread.join();
+	if(label != nullptr) fprintf(stderr, "\n");
+}
+
+std::string makeRunDirectory(const char* name){
+	std::string pattern = std::string("/tmp/") + name + "_XXXXXX";
+	std::vector<char> directory (pattern.begin(), pattern.end());
+	directory.push_back('\0');
+	if(mkdtemp(directory.data()) == nullptr){
+		perror("mkdtemp");
+		std::exit(1);
+	}
+	return directory.data();
+}
+
+void removeRunDirectory(const std::string& directory){
+	rmdir(directory.c_str());
+}
@@ -0,0 +1,54 @@
+#ifndef _SIM_RUN_HPP_
+#define _SIM_RUN_HPP_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*=============
+** SIMULATOR RUNS
+=============*/
+/*Shared by the tools that drive the simulator (bin/host/sim) as a subprocess. The robot code keeps its state
+	in globals, so each run is its own process and parallel runs are parallel processes.*/
+
+struct SimSegment{
+	char kind[16];
+	long start_ms;              //From the start of autonomous()
+	long end_ms;
+	long duration_ms;
+	char exit[16];
+	double goal_x;
+	double goal_y;
+	double position_error;
+};
+
+struct SimRun{
+	bool valid = false;         //The sim ran and printed its summary
+	bool finished = false;      //The routine returned before time ran out
+	long time_ms = 0;
+	int scored = 0;
+	int scored_theirs = 0;
+	std::vector<long> goal_times;   //When each of our balls went in, from the start of autonomous()
+	std::vector<SimSegment> segments;
+};
+
+//The sim next to the tool that's running (argv[0])
+std::string defaultSimPath(const char* argv0);
+
+//Runs `sim --no-sd <arguments>` with its serial output in serial_path, which is deleted afterwards
+SimRun runSim(const std::string& sim_path, const std::string& arguments, const std::string& serial_path);
+
+//Mean distance from the goal at the end of the run's segments
+double meanPositionError(const SimRun& run);
+
+//Our balls scored during each segment (by index), every ball counted in the last score segment started before it went in
+std::vector<int> goalsBySegment(const SimRun& run);
+
+//Calls job(0) to job(count - 1) from a pool of threads, counting them off on stderr as "[label] done/count"
+void runParallel(int count, int threads, const char* label, const std::function<void(int)>& job);
+
+//A directory in /tmp for the runs' serial files, removed by removeRunDirectory() once they are gone
+std::string makeRunDirectory(const char* name);
+void removeRunDirectory(const std::string& directory);
+
+#endif
@@ -0,0 +1,169 @@
+/*Runs SpscQueue between two real threads and checks what comes out (make test).
+
+	spsc_stress [items]
+
+	A producer thread pushes items numbers in order (default 1000000), retrying whenever the queue is full,
+	and a consumer thread takes them out, once polling pop() and once sleeping in popWait() like the
+	drivetrain task. Every item carries its number and a checksum of it, so the consumer catches anything
+	lost, duplicated, reordered or torn. Each run prints its throughput and how often the producer found the
+	queue full; the exit status is 1 if any item came out wrong.
+
+	The PROS calls the queue makes (task notifications and millis()) are stood in for by a condition variable
+	and the steady clock.*/
+
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#define STRESS_ITEMS 1000000
+//Same capacity as the robot's command queues, so the full and empty paths get a workout
+#define STRESS_CAPACITY 8
+#define STRESS_WAIT_MS 100
+
+typedef std::chrono::steady_clock Clock;
+
+/*=============
+** PROS STAND-INS
+=============*/
+//One consumer per run, so one notification count is enough
+static std::mutex notify_mutex;
+static std::condition_variable notify_signal;
+static std::uint32_t notify_count = 0;
+static const Clock::time_point start_time = Clock::now();
+
+namespace pros{
+namespace c{
+
+std::uint32_t millis(){
+	return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count();
+}
+
+std::uint32_t task_notify(task_t){
+	std::lock_guard<std::mutex> lock (notify_mutex);
+	notify_count += 1;
+	notify_signal.notify_one();
+	return 1;
+}
+
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout){
+	std::unique_lock<std::mutex> lock (notify_mutex);
+	notify_signal.wait_for(lock, std::chrono::milliseconds(timeout), []{ return notify_count > 0; });
+	std::uint32_t count = notify_count;
+	if(count > 0) notify_count = clear_on_exit ? 0 : count - 1;
+	return count;
+}
+
+}
+
+/*=============
+** STRESS
+=============*/
+struct StressItem{
+	std::uint64_t number;
+	std::uint64_t check;
+};
+
+static std::uint64_t checksum(std::uint64_t number){
+	return number * 0x9E3779B97F4A7C15ull ^ 0x5327;
+}
+
+struct StressResult{
+	double seconds;
+	std::uint64_t received;
+	std::uint64_t wrong;
+	std::uint64_t full;
+	std::uint64_t timeouts;
+};
+
+static StressResult runStress(std::uint64_t items, bool sleeping){
+	SpscQueue<StressItem, STRESS_CAPACITY> queue;
+	StressResult result = {0, 0, 0, 0, 0};
+
+	Clock::time_point start = Clock::now();
+
+	std::atomic<bool> produced (false);
+
+	std::thread consumer ([&]{
+		//Any non-null handle makes push() notify
+		if(sleeping) queue.setConsumer(reinterpret_cast<pros::task_t>(1));
+
+		std::uint64_t expected = 0;
+		while(expected < items){
+			StressItem item;
+			bool got = sleeping ? queue.popWait(item, STRESS_WAIT_MS) : queue.pop(item);
+			if(got == false){
+				//Producer is done and the queue is empty, so the rest were lost
+				if(produced && queue.empty()){
+					result.wrong += items - expected;
+					break;
+				}
+				if(sleeping) result.timeouts += 1;
+				//Gives the producer the core when there's only one
+				else std::this_thread::yield();
+				continue;
+			}
+			result.received += 1;
+
+			if(item.number == expected && item.check == checksum(item.number)){
+				expected += 1;
+				continue;
+			}
+
+			//Torn, repeated or out of order (doesn't move on), or a gap (skips ahead)
+			if(result.wrong == 0){
+				printf("expected item %llu, got %llu (check %s)\n", (unsigned long long)expected, (unsigned long long)item.number,
+					item.check == checksum(item.number) ? "ok" : "torn");
+			}
+			result.wrong += 1;
+			if(item.number > expected) expected = item.number + 1;
+		}
+	});
+
+	std::thread producer ([&]{
+		for(std::uint64_t number = 0; number < items; number++){
+			StressItem item = {number, checksum(number)};
+			while(queue.push(item) == false){
+				result.full += 1;
+				std::this_thread::yield();
+			}
+		}
+		produced = true;
+	});
+
+	producer.join();
+	consumer.join();
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	//Anything left over was pushed but never seen
+	StressItem left;
+	while(queue.pop(left)) result.wrong += 1;
+	return result;
+}
+
+int main(int argc, char** argv){
+	if(argc > 2){
+		fprintf(stderr, "usage: %s [items]\n", argv[0]);
+		return 1;
+	}
+	std::uint64_t items = argc == 2 ? std::strtoull(argv[1], nullptr, 10) : STRESS_ITEMS;
+
+	printf("%-18s %12s %10s %10s %12s %10s %10s\n", "consumer", "items", "wrong", "ns/item", "Mitems/s", "full", "timeouts");
+	bool ok = true;
+	for(bool sleeping : {false, true}){
+		StressResult result = runStress(items, sleeping);
+		printf("%-18s %12llu %10llu %10.1f %12.2f %10llu %10llu\n", sleeping ? "popWait (sleeps)" : "pop (polls)",
+			(unsigned long long)result.received, (unsigned long long)result.wrong, result.seconds * 1e9 / items,
+			items / result.seconds / 1e6, (unsigned long long)result.full, (unsigned long long)result.timeouts);
+		if(result.wrong > 0 || result.received != items) ok = false;
+	}
+
+	printf("\n%s\n", ok ? "PASS" : "FAIL: items were lost, repeated, reordered or torn");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*Host side decoder for the robot's binary telemetry stream (see include/telemetry_codec.hpp).
+
+	telemetry_decode /dev/ttyACM1    reads the brain's serial port
+	telemetry_decode --pty           opens a pseudo terminal and prints its name, anything written to it
+	                                 (a recorded capture, the simulator) gets decoded like the real port
+	telemetry_decode capture.bin     decodes a saved capture
+
+	Frames come out on stdout as CSV, printf() text from the robot goes to stderr.*/
+
+#include "telemetry_codec.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static void makeRaw(int fd){
+	termios settings;
+	if(tcgetattr(fd, &settings) != 0) return;
+	cfmakeraw(&settings);
+	tcsetattr(fd, TCSANOW, &settings);
+}
+
+//Anything between two delimiters that isn't a frame is printed if it looks like text
+static void printText(const std::uint8_t* data, std::size_t size){
+	for(std::size_t i = 0; i < size; i++){
+		if(!isprint(data[i]) && !isspace(data[i])) return;
+	}
+	fwrite(data, 1, size, stderr);
+}
+
+static void printFrame(const TelemetryFrame& frame){
+	for(int i = 0; i < TLM_FIELD_COUNT; i++){
+		printf(i == 0 ? "%ld" : ",%ld", (long)frame.values[i]);
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+int main(int argc, char** argv){
+	if(argc != 2){
+		fprintf(stderr, "usage: %s <serial port | capture file | --pty>\n", argv[0]);
+		return 1;
+	}
+
+	int fd;
+	int pty_slave = -1;
+	if(strcmp(argv[1], "--pty") == 0){
+		fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if(fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0){
+			perror("posix_openpt");
+			return 1;
+		}
+
+		//Holding the slave open keeps reads from failing every time a writer closes it
+		pty_slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+		makeRaw(pty_slave);
+		fprintf(stderr, "[telemetry] reading from %s\n", ptsname(fd));
+	}
+	else{
+		fd = open(argv[1], O_RDONLY | O_NOCTTY);
+		if(fd < 0){
+			perror(argv[1]);
+			return 1;
+		}
+		if(isatty(fd)) makeRaw(fd);
+	}
+
+	for(int i = 0; i < TLM_FIELD_COUNT; i++) printf(i == 0 ? "%s" : ",%s", TELEMETRY_FIELD_NAMES[i]);
+	printf("\n");
+
+	TelemetryDecoder decoder;
+	TelemetryFrame frame;
+	std::uint32_t frames = 0;
+	std::uint32_t rejected = 0;
+
+	//Text lines can be long, anything past the end of the buffer is dropped until the next delimiter
+	std::uint8_t packet[4096];
+	std::size_t packet_size = 0;
+	bool overflow = false;
+
+	std::uint8_t buffer[4096];
+	ssize_t size;
+	while((size = read(fd, buffer, sizeof(buffer))) > 0){
+		for(ssize_t i = 0; i < size; i++){
+			if(buffer[i] != 0){
+				if(packet_size < sizeof(packet)) packet[packet_size++] = buffer[i];
+				else overflow = true;
+				continue;
+			}
+
+			if(packet_size > 0 && overflow == false){
+				if(decoder.decode(packet, packet_size, frame)){
+					printFrame(frame);
+					frames += 1;
+				}
+				else{
+					printText(packet, packet_size);
+					rejected += 1;
+				}
+			}
+			packet_size = 0;
+			overflow = false;
+		}
+	}
+
+	fprintf(stderr, "[telemetry] %lu frames, %lu missed, %lu other packets\n",
+		(unsigned long)frames, (unsigned long)decoder.missed(), (unsigned long)rejected);
+	if(pty_slave >= 0) close(pty_slave);
+	close(fd);
+	return 0;
+}